@@ -0,0 +1,1104 @@
+//created by drmrsthemonarch with ai effort
+// Storage benchmarks; built with -DSLEEPBOOK_BUILD_BENCHMARKS=ON.
+//
+//   storagebench [--only kdf|keystream|cipher|records|compression|read|commit|reindex|import|export|statistics|correlation|lag|rollup|regression]
+//                [--records N] [--notes-bytes N] [--megabytes N] [--saves N] [--rows N]
+//
+// kdf:       one login-time password derivation against the per-file
+//            subkey and the SHA-256 every file access used to repeat
+// keystream: throughput of the XOR kernel against the original
+//            per-byte QByteArray loop
+// cipher:    ChaCha20-Poly1305 seal and open against the version 1 XOR
+//            kernel, in memory and through loadEncrypted on a file of the
+//            same size in each format
+// records:   a synthetic summary history as the old QVariantMap stream and
+//            as binary records; size, encode and decode time, and the cost
+//            of opening the records without decoding them into maps
+// compression: the same history written with and without segment
+//            compression; file sizes, ratio and load throughput
+// read:      fills a temporary detail pack with synthetic nights and times
+//            a cold batch decrypt and parse of all of them at 1, 2, 4, ...
+//            threads
+// commit:    detail record saves synced one by one, grouped into a single
+//            StorageBatch, and only flushed
+// reindex:   rebuilds the pack index and a drifted summary from a synthetic
+//            detail pack, then checks the rebuilt summary against it
+// import:    parses a synthetic spreadsheet export with the CSV importer,
+//            then stores the rows in a detail pack as one batch
+// export:    CSV export of a growing synthetic history into a device that
+//            only counts bytes; time per row should stay flat
+// statistics: summary statistics rebuilt from a synthetic table against
+//            the per-edit update EntryStore applies, checked to agree
+// correlation: all-pairs Pearson and Spearman matrices of 100 synthetic
+//            symptom columns over ten years of nights
+// lag:       lagged correlation of eight symptoms against sleep duration
+//            over ten years with missing days, for a short lag range summed
+//            directly and a long one through FFTs
+// rollup:    builds the night/week/month/quarter pyramid of a synthetic
+//            history and reads a level back, as a zoomed plot does
+// regression: sleep duration on 20 synthetic symptoms, over the whole
+//            history and over a year-long window dragged across it, with
+//            and without a ridge penalty; checked to recover the planted
+//            coefficients
+#include "classes/chacha20poly1305.h"
+#include "classes/correlationmatrix.h"
+#include "classes/csvexporter.h"
+#include "classes/csvimporter.h"
+#include "classes/dataencryption.h"
+#include "classes/detailstore.h"
+#include "classes/encrypteddevice.h"
+#include "classes/laggedcorrelation.h"
+#include "classes/linearregression.h"
+#include "classes/reindex.h"
+#include "classes/rolluppyramid.h"
+#include "classes/sessionkey.h"
+#include "classes/sleeptable.h"
+#include "classes/storagesync.h"
+#include "classes/summarycodec.h"
+#include "classes/summaryentries.h"
+#include "classes/summarystatistics.h"
+#include "classes/sleepentry.h"
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QUuid>
+#include <QVariantMap>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+const QString Password = "benchmark-password";
+
+// Cheap derivation; the benchmarks below time the file paths, not the KDF
+SessionKey benchmarkKey() {
+    return SessionKey::derive(Password, QByteArray("storagebench-salt"), 1);
+}
+
+int intArgument(const QStringList& args, const QString& name, int fallback) {
+    int i = args.indexOf(name);
+    return i >= 0 && i + 1 < args.size() ? args[i + 1].toInt() : fallback;
+}
+
+SleepEntry syntheticEntry(const QDate& date, int notesBytes, QRandomGenerator& random) {
+    static const QStringList words = {"restless", "coffee", "late", "dream", "woke",
+                                      "headache", "quiet", "tired", "walk", "alcohol"};
+    SleepEntry entry;
+    entry.timestamp = QDateTime(date.addDays(1), QTime(7, 0));
+    entry.date = date;
+    entry.bedtime = QTime(22, 0).addSecs(random.bounded(7200));
+    entry.waketime = QTime(6, 0).addSecs(random.bounded(7200));
+    entry.hours = 6.0 + random.bounded(3.0);
+    while (entry.notes.size() < notesBytes) {
+        entry.notes += words[random.bounded(words.size())] + ' ';
+    }
+    entry.symptomData.append(qMakePair(QString("Headache"), double(random.bounded(4))));
+    entry.symptomData.append(qMakePair(QString("Coffee"), double(random.bounded(5))));
+    return entry;
+}
+
+// The loop DataEncryption::encrypt used before the word-wide kernel
+QByteArray legacyEncrypt(const QByteArray& data, const QByteArray& key) {
+    QByteArray encrypted;
+    encrypted.resize(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        encrypted[i] = data[i] ^ key[i % key.size()];
+    }
+    return encrypted;
+}
+
+double gigabytesPerSecond(qint64 bytes, qint64 nsecs) {
+    return nsecs > 0 ? double(bytes) / double(nsecs) : 0.0;
+}
+
+int benchmarkKeyDerivation(QTextStream& out) {
+    const int perFileRounds = 100000;
+    QByteArray salt = SessionKey::generateSalt();
+
+    QElapsedTimer timer;
+    timer.start();
+    SessionKey key = SessionKey::derive(Password, salt, SessionKey::DefaultIterations);
+    double loginMs = timer.nsecsElapsed() / 1e6;
+
+    // What every encrypt/decrypt call did before the session key
+    QByteArray utf8;
+    timer.restart();
+    for (int i = 0; i < perFileRounds; ++i) {
+        utf8 = Password.toUtf8();
+        utf8 = QCryptographicHash::hash(utf8, QCryptographicHash::Sha256);
+    }
+    double rehashNs = double(timer.nsecsElapsed()) / perFileRounds;
+
+    timer.restart();
+    QByteArray subkey;
+    for (int i = 0; i < perFileRounds; ++i) {
+        subkey = key.subkey(QByteArray("sleep_details.pack"));
+    }
+    double subkeyNs = double(timer.nsecsElapsed()) / perFileRounds;
+
+    out << "key derivation\n";
+    out << "  login KDF (" << SessionKey::DefaultIterations << " iterations)  "
+        << QString::number(loginMs, 'f', 1) << " ms, once per session\n";
+    out << "  password re-hash per file access    " << QString::number(rehashNs, 'f', 0)
+        << " ns (before)\n";
+    out << "  subkey derivation                   " << QString::number(subkeyNs, 'f', 0)
+        << " ns\n";
+    return 0;
+}
+
+int benchmarkKeystream(QTextStream& out, int megabytes) {
+    QByteArray key = benchmarkKey().legacyKey();
+    QByteArray data(megabytes * 1024 * 1024, Qt::Uninitialized);
+    QRandomGenerator random(7);
+    random.fillRange(reinterpret_cast<quint32*>(data.data()), data.size() / 4);
+
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray expected = legacyEncrypt(data, key);
+    qint64 legacyNsecs = timer.nsecsElapsed();
+
+    // Best of five in-place passes over a fresh copy
+    QByteArray buffer;
+    qint64 kernelNsecs = 0;
+    for (int round = 0; round < 5; ++round) {
+        buffer = data;
+        buffer.detach();
+        timer.restart();
+        DataEncryption::applyKeystream(buffer.data(), buffer.size(), key);
+        qint64 elapsed = timer.nsecsElapsed();
+        kernelNsecs = round == 0 ? elapsed : std::min(kernelNsecs, elapsed);
+    }
+    if (buffer != expected) {
+        out << "keystream kernel output differs from the legacy loop\n";
+        return 1;
+    }
+
+    double legacy = gigabytesPerSecond(data.size(), legacyNsecs);
+    double kernel = gigabytesPerSecond(data.size(), kernelNsecs);
+    out << "keystream over " << megabytes << " MiB\n";
+    out << "  legacy per-byte loop  " << QString::number(legacy, 'f', 2) << " GB/s\n";
+    out << "  in-place kernel       " << QString::number(kernel, 'f', 2) << " GB/s ("
+        << QString::number(kernel / legacy, 'f', 1) << "x)\n\n";
+    return 0;
+}
+
+double megabytesPerSecond(qint64 bytes, qint64 nsecs) {
+    return nsecs > 0 ? double(bytes) * 1e3 / double(nsecs) : 0.0;
+}
+
+// The file layout DataEncryption::saveEncrypted wrote before version 2
+bool writeVersion1File(const QString& path, const QByteArray& data, const SessionKey& key) {
+    QByteArray encrypted = data;
+    encrypted.detach();
+    DataEncryption::applyKeystream(encrypted.data(), encrypted.size(), key.legacyKey());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << quint32(0x534C5050) << quint32(1) << encrypted;
+    return out.status() == QDataStream::Ok;
+}
+
+// Best of three loads, in nanoseconds; -1 if the payload came back wrong
+qint64 timeLoad(const QString& path, const QByteArray& expected, const SessionKey& key) {
+    qint64 best = -1;
+    for (int round = 0; round < 3; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray loaded = DataEncryption::loadEncrypted(path, key);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (loaded != expected) {
+            return -1;
+        }
+        best = best < 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+int benchmarkCipher(QTextStream& out, int megabytes) {
+    SessionKey key = benchmarkKey();
+    QByteArray data(megabytes * 1024 * 1024, Qt::Uninitialized);
+    QRandomGenerator random(11);
+    random.fillRange(reinterpret_cast<quint32*>(data.data()), data.size() / 4);
+
+    const uchar* cipherKey = reinterpret_cast<const uchar*>(key.cipherKey().constData());
+    const uchar nonce[ChaCha20Poly1305::NonceSize] = {};
+    uchar tag[ChaCha20Poly1305::TagSize];
+
+    // Best of three in-place passes over a fresh copy for each kernel
+    QElapsedTimer timer;
+    qint64 xorNsecs = 0, sealNsecs = 0, openNsecs = 0;
+    QByteArray buffer;
+    for (int round = 0; round < 3; ++round) {
+        buffer = data;
+        buffer.detach();
+        timer.start();
+        DataEncryption::applyKeystream(buffer.data(), buffer.size(), key.legacyKey());
+        qint64 xorElapsed = timer.nsecsElapsed();
+
+        buffer = data;
+        buffer.detach();
+        timer.restart();
+        ChaCha20Poly1305::seal(cipherKey, nonce, nullptr, 0, buffer.data(), buffer.size(), tag);
+        qint64 sealElapsed = timer.nsecsElapsed();
+
+        timer.restart();
+        bool opened = ChaCha20Poly1305::open(cipherKey, nonce, nullptr, 0, buffer.data(),
+                                             buffer.size(), tag);
+        qint64 openElapsed = timer.nsecsElapsed();
+        if (!opened || buffer != data) {
+            out << "ChaCha20-Poly1305 round trip failed\n";
+            return 1;
+        }
+
+        xorNsecs = round == 0 ? xorElapsed : std::min(xorNsecs, xorElapsed);
+        sealNsecs = round == 0 ? sealElapsed : std::min(sealNsecs, sealElapsed);
+        openNsecs = round == 0 ? openElapsed : std::min(openNsecs, openElapsed);
+    }
+
+    QTemporaryDir dir;
+    QString version1Path = dir.filePath("version1.dat");
+    QString version2Path = dir.filePath("version2.dat");
+    if (!dir.isValid() || !writeVersion1File(version1Path, data, key)
+        || !DataEncryption::saveEncrypted(version2Path, data, key)) {
+        out << "could not write the benchmark files\n";
+        return 1;
+    }
+    qint64 version1Nsecs = timeLoad(version1Path, data, key);
+    qint64 version2Nsecs = timeLoad(version2Path, data, key);
+    if (version1Nsecs < 0 || version2Nsecs < 0) {
+        out << "loadEncrypted returned the wrong payload\n";
+        return 1;
+    }
+
+    auto rate = [&data](qint64 nsecs) {
+        return QString::number(megabytesPerSecond(data.size(), nsecs), 'f', 0) + " MB/s\n";
+    };
+    out << "cipher over " << megabytes << " MiB\n";
+    out << "  v1 XOR kernel           " << rate(xorNsecs);
+    out << "  ChaCha20-Poly1305 seal  " << rate(sealNsecs);
+    out << "  ChaCha20-Poly1305 open  " << rate(openNsecs);
+    out << "  loadEncrypted, v1 file  " << rate(version1Nsecs);
+    out << "  loadEncrypted, v2 file  " << rate(version2Nsecs) << "\n";
+    return 0;
+}
+
+// The summary list as EntryStore holds it, one map per night
+QList<QVariantMap> syntheticSummary(int records) {
+    static const QStringList symptoms = {"Headache", "Coffee", "Alcohol", "Exercise",
+                                         "Stress", "Screen time", "Nap", "Anxiety"};
+    QRandomGenerator random(23);
+    QList<QVariantMap> entries;
+    QDate first = QDate::currentDate().addDays(-records);
+    for (int i = 0; i < records; ++i) {
+        QVariantMap entry;
+        entry["id"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        entry["date"] = first.addDays(i);
+        entry["sleep_duration"] = 6.0 + random.bounded(3.0);
+        for (const QString& symptom : symptoms) {
+            entry[symptom] = double(random.bounded(5));
+        }
+        entries.append(entry);
+    }
+    return entries;
+}
+
+QByteArray encodeSummary(const QList<QVariantMap>& entries) {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    SummaryCodec::write(buffer, entries);
+    return data;
+}
+
+int benchmarkRecords(QTextStream& out, int records) {
+    QList<QVariantMap> entries = syntheticSummary(records);
+
+    // Best of three for each direction of each layout
+    QElapsedTimer timer;
+    qint64 streamWrite = 0, streamRead = 0, binaryWrite = 0, binaryRead = 0, lazyOpen = 0;
+    QByteArray streamed, binary;
+    for (int round = 0; round < 3; ++round) {
+        streamed.clear();
+        timer.start();
+        QDataStream streamOut(&streamed, QIODevice::WriteOnly);
+        streamOut.setVersion(QDataStream::Qt_5_15);
+        streamOut << entries;
+        qint64 writeElapsed = timer.nsecsElapsed();
+
+        QList<QVariantMap> streamedBack;
+        timer.restart();
+        QDataStream streamIn(streamed);
+        streamIn.setVersion(QDataStream::Qt_5_15);
+        streamIn >> streamedBack;
+        qint64 readElapsed = timer.nsecsElapsed();
+
+        timer.restart();
+        binary = encodeSummary(entries);
+        qint64 binaryWriteElapsed = timer.nsecsElapsed();
+
+        QList<QVariantMap> binaryBack;
+        QBuffer buffer(&binary);
+        buffer.open(QIODevice::ReadOnly);
+        timer.restart();
+        bool decoded = SummaryCodec::read(buffer, binaryBack);
+        qint64 binaryReadElapsed = timer.nsecsElapsed();
+
+        // What EntryStore does: keep the rows and index the ids only
+        SummaryRecords records;
+        buffer.seek(0);
+        timer.restart();
+        decoded = decoded && SummaryCodec::read(buffer, records);
+        SummaryEntries lazy(records);
+        qint64 lazyElapsed = timer.nsecsElapsed();
+        if (!decoded || binaryBack != entries || streamedBack != entries
+            || lazy.toList() != entries) {
+            out << "summary records did not round-trip\n";
+            return 1;
+        }
+
+        streamWrite = round == 0 ? writeElapsed : std::min(streamWrite, writeElapsed);
+        streamRead = round == 0 ? readElapsed : std::min(streamRead, readElapsed);
+        binaryWrite = round == 0 ? binaryWriteElapsed : std::min(binaryWrite, binaryWriteElapsed);
+        binaryRead = round == 0 ? binaryReadElapsed : std::min(binaryRead, binaryReadElapsed);
+        lazyOpen = round == 0 ? lazyElapsed : std::min(lazyOpen, lazyElapsed);
+    }
+
+    auto ms = [](qint64 nsecs) { return QString::number(nsecs / 1e6, 'f', 1) + " ms"; };
+    out << "summary records: " << records << " nights\n";
+    out << "  QVariantMap stream  " << streamed.size() / 1024 << " KiB, encode "
+        << ms(streamWrite) << ", decode " << ms(streamRead) << "\n";
+    out << "  binary records      " << binary.size() / 1024 << " KiB, encode "
+        << ms(binaryWrite) << ", decode " << ms(binaryRead) << "\n";
+    out << "  binary, maps on use " << ms(lazyOpen) << " to open\n";
+    out << "  size ratio          "
+        << QString::number(double(streamed.size()) / double(qMax(binary.size(), 1)), 'f', 1)
+        << "x\n\n";
+    return 0;
+}
+
+bool writeSegmented(const QString& path, const QByteArray& data, const SessionKey& key,
+                    bool compress) {
+    EncryptedDevice device(path, key);
+    device.setCompressionEnabled(compress);
+    if (!device.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    bool ok = device.write(data) == data.size();
+    device.close();
+    return ok && device.isOk();
+}
+
+int benchmarkCompression(QTextStream& out, int records) {
+    SessionKey key = benchmarkKey();
+    QByteArray data = encodeSummary(syntheticSummary(records));
+
+    QTemporaryDir dir;
+    QString rawPath = dir.filePath("raw.dat");
+    QString compressedPath = dir.filePath("compressed.dat");
+    QElapsedTimer timer;
+    timer.start();
+    bool written = dir.isValid() && writeSegmented(rawPath, data, key, false);
+    qint64 rawWriteNsecs = timer.nsecsElapsed();
+    timer.restart();
+    written = written && writeSegmented(compressedPath, data, key, true);
+    qint64 compressedWriteNsecs = timer.nsecsElapsed();
+    if (!written) {
+        out << "could not write the benchmark files\n";
+        return 1;
+    }
+
+    qint64 rawNsecs = timeLoad(rawPath, data, key);
+    qint64 compressedNsecs = timeLoad(compressedPath, data, key);
+    if (rawNsecs < 0 || compressedNsecs < 0) {
+        out << "loadEncrypted returned the wrong payload\n";
+        return 1;
+    }
+
+    qint64 rawSize = QFileInfo(rawPath).size();
+    qint64 compressedSize = QFileInfo(compressedPath).size();
+    auto rate = [&data](qint64 nsecs) {
+        return QString::number(megabytesPerSecond(data.size(), nsecs), 'f', 0) + " MB/s";
+    };
+    out << "summary history: " << records << " nights, " << data.size() / 1024
+        << " KiB serialized\n";
+    out << "  uncompressed file  " << rawSize / 1024 << " KiB, write "
+        << rate(rawWriteNsecs) << ", load " << rate(rawNsecs) << "\n";
+    out << "  compressed file    " << compressedSize / 1024 << " KiB, write "
+        << rate(compressedWriteNsecs) << ", load " << rate(compressedNsecs) << "\n";
+    out << "  ratio              "
+        << QString::number(double(rawSize) / double(qMax<qint64>(compressedSize, 1)), 'f', 2)
+        << "x\n\n";
+    return 0;
+}
+
+// Best of three, in milliseconds
+double timeFullRead(const DetailStore::ReadPlan& plan) {
+    double best = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        QFile pack(plan.packFile);
+        pack.open(QIODevice::ReadOnly);
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<SleepEntry> entries =
+            DetailStore::readEntries(pack, plan, 0, plan.records.size());
+        double elapsed = timer.nsecsElapsed() / 1e6;
+
+        if (entries.size() != plan.records.size()) {
+            return -1.0;
+        }
+        best = round == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+int benchmarkDetailRead(QTextStream& out, int records, int notesBytes) {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        out << "could not create a temporary directory\n";
+        return 1;
+    }
+
+    DetailStore store;
+    if (!store.open(dir.path(), benchmarkKey())) {
+        out << "could not open the detail pack\n";
+        return 1;
+    }
+
+    QRandomGenerator random(42);
+    QVector<QUuid> ids;
+    ids.reserve(records);
+    QDate first = QDate::currentDate().addDays(-records);
+    for (int i = 0; i < records; ++i) {
+        SleepEntry entry = syntheticEntry(first.addDays(i), notesBytes, random);
+        store.write(entry.id, entry.toDetailRecord());
+        ids.append(entry.id);
+    }
+
+    DetailStore::ReadPlan plan = store.planRead(ids);
+    out << "detail records: " << records << ", notes: ~" << notesBytes << " bytes, pack: "
+        << QFileInfo(plan.packFile).size() / 1024 << " KiB\n";
+    out << "threads   ms        speedup\n";
+
+    // Powers of two up to the core count, plus the core count itself
+    QVector<int> threadCounts;
+    int maxThreads = QThread::idealThreadCount();
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.append(threads);
+    }
+    threadCounts.append(maxThreads);
+
+    double baseline = 0.0;
+    for (int threads : threadCounts) {
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+        double ms = timeFullRead(plan);
+        if (ms < 0) {
+            out << "read returned the wrong number of records\n";
+            return 1;
+        }
+        if (baseline == 0.0) {
+            baseline = ms;
+        }
+        out << qSetFieldWidth(10) << Qt::left << threads << QString::number(ms, 'f', 1)
+            << QString::number(baseline / ms, 'f', 2) + "x" << qSetFieldWidth(0) << "\n";
+    }
+    out << "\n";
+    return 0;
+}
+
+// Milliseconds to save count synthetic nights into a fresh pack
+double timeSaves(int count, bool batched) {
+    QTemporaryDir dir;
+    DetailStore store;
+    if (!dir.isValid() || !store.open(dir.path(), benchmarkKey())) {
+        return -1.0;
+    }
+
+    QRandomGenerator random(5);
+    QDate first = QDate::currentDate().addDays(-count);
+    QVector<SleepEntry> entries;
+    for (int i = 0; i < count; ++i) {
+        entries.append(syntheticEntry(first.addDays(i), 200, random));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QScopedPointer<StorageBatch> batch(batched ? new StorageBatch : nullptr);
+        for (const SleepEntry& entry : entries) {
+            if (!store.write(entry.id, entry.toDetailRecord())) {
+                return -1.0;
+            }
+        }
+        if (batch && !batch->commit()) {
+            return -1.0;
+        }
+    }
+    return timer.nsecsElapsed() / 1e6;
+}
+
+int benchmarkCommit(QTextStream& out, int saves) {
+    double synced = timeSaves(saves, false);
+    double batched = timeSaves(saves, true);
+    StorageSync::setPolicy(StorageSync::Policy::Flush);
+    double flushed = timeSaves(saves, false);
+    StorageSync::setPolicy(StorageSync::Policy::Commit);
+    if (synced < 0 || batched < 0 || flushed < 0) {
+        out << "could not save into the detail pack\n";
+        return 1;
+    }
+
+    auto line = [saves](double ms) {
+        return QString::number(ms, 'f', 1) + " ms (" + QString::number(ms * 1e3 / saves, 'f', 0)
+               + " us per save)\n";
+    };
+    out << "commit of " << saves << " detail saves\n";
+    out << "  fsync per save      " << line(synced);
+    out << "  one StorageBatch    " << line(batched);
+    out << "  flush only          " << line(flushed) << "\n";
+    return 0;
+}
+
+int benchmarkReindex(QTextStream& out, int records, int notesBytes) {
+    QTemporaryDir dir;
+    DetailStore store;
+    if (!dir.isValid() || !store.open(dir.path(), benchmarkKey())) {
+        out << "could not open the detail pack\n";
+        return 1;
+    }
+
+    // Drift one summary entry in fifty each way, as a save cut off between
+    // its detail record and its journal record would
+    QRandomGenerator random(11);
+    QList<QVariantMap> summary;
+    QDate first = QDate::currentDate().addDays(-records);
+    {
+        StorageBatch batch;
+        for (int i = 0; i < records; ++i) {
+            SleepEntry entry = syntheticEntry(first.addDays(i), notesBytes, random);
+            store.write(entry.id, entry.toDetailRecord());
+            QVariantMap map = entry.toVariantMap();
+            if (i % 50 == 1) {
+                continue;
+            }
+            if (i % 50 == 2) {
+                map["sleep_duration"] = entry.hours + 1.0;
+            }
+            summary.append(map);
+        }
+    }
+
+    QList<QVariantMap> rebuilt;
+    Reindex::Report report = Reindex::run(store, SummaryEntries(summary), &rebuilt);
+    if (!report.ok) {
+        out << "could not read the detail pack\n";
+        return 1;
+    }
+    out << "reindex of " << records << " detail records, notes: ~" << notesBytes << " bytes\n"
+        << report.toString() << "\n";
+
+    Reindex::Report check = Reindex::run(store, SummaryEntries(rebuilt));
+    if (!check.isConsistent() || check.orphaned != 0) {
+        out << "the rebuilt summary does not match the detail records\n";
+        return 1;
+    }
+    out << "rebuilt summary matches the detail records\n\n";
+    return 0;
+}
+
+// As another tracker would export it: quoted notes with commas in them, a
+// yes/no column and a column no symptom exists for yet
+QByteArray syntheticCsv(int rows, int notesBytes) {
+    QRandomGenerator random(31);
+    QByteArray csv = "Date,Bedtime,Wake time,Sleep duration,Headache,Coffee,Nap,Notes\n";
+    QDate first = QDate::currentDate().addDays(-rows);
+    for (int i = 0; i < rows; ++i) {
+        SleepEntry entry = syntheticEntry(first.addDays(i), notesBytes, random);
+        csv += entry.date.toString("yyyy-MM-dd").toUtf8() + ','
+               + entry.bedtime.toString("HH:mm").toUtf8() + ','
+               + entry.waketime.toString("HH:mm").toUtf8() + ','
+               + QByteArray::number(entry.hours, 'f', 2) + ','
+               + QByteArray::number(entry.symptomData[0].second) + ','
+               + QByteArray::number(entry.symptomData[1].second) + ','
+               + (random.bounded(2) ? "yes" : "no") + ",\"" + entry.notes.toUtf8().replace(' ', ", ")
+               + "\"\n";
+    }
+    return csv;
+}
+
+int benchmarkImport(QTextStream& out, int rows, int notesBytes) {
+    QByteArray csv = syntheticCsv(rows, notesBytes);
+    const QList<Symptom> symptoms = {Symptom("Headache", SymptomType::Count),
+                                     Symptom("Coffee", SymptomType::Count)};
+
+    // Best of three
+    double parseMs = 0.0;
+    QVector<SleepEntry> entries;
+    for (int round = 0; round < 3; ++round) {
+        QBuffer buffer(&csv);
+        buffer.open(QIODevice::ReadOnly);
+        CsvImporter importer(symptoms);
+
+        QElapsedTimer timer;
+        timer.start();
+        bool parsed = importer.read(buffer);
+        double elapsed = timer.nsecsElapsed() / 1e6;
+
+        if (!parsed || importer.entries().size() != rows || importer.newSymptoms().size() != 1) {
+            out << "the importer did not read back the rows it was given\n";
+            return 1;
+        }
+        // Rows without an Id column must map to the same entries every time
+        if (round > 0 && importer.entries().last().id != entries.last().id) {
+            out << "reading the same rows again gave them new ids\n";
+            return 1;
+        }
+        parseMs = round == 0 ? elapsed : std::min(parseMs, elapsed);
+        entries = importer.entries();
+    }
+
+    // What EntryStore::importEntries does with the details: serialize on the
+    // pool, then seal and append everything in one synced batch
+    QTemporaryDir dir;
+    DetailStore store;
+    if (!dir.isValid() || !store.open(dir.path(), benchmarkKey())) {
+        out << "could not open the detail pack\n";
+        return 1;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QPair<QUuid, QByteArray>> records(entries.size());
+    QPair<QUuid, QByteArray>* slot = records.data();
+    QVector<int> indexes(entries.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&entries, slot](int& i) {
+        slot[i] = qMakePair(entries[i].id, entries[i].toDetailRecord());
+    });
+    StorageBatch batch;
+    if (!store.writeMany(records) || !batch.commit()) {
+        out << "could not store the imported rows\n";
+        return 1;
+    }
+    double storeMs = timer.nsecsElapsed() / 1e6;
+
+    auto rate = [rows](double ms) {
+        return QString::number(ms, 'f', 1) + " ms (" + QString::number(qRound64(rows / (ms / 1e3)))
+               + " rows/s";
+    };
+    out << "import of " << rows << " CSV rows, " << csv.size() / 1024 << " KiB\n";
+    out << "  parse   " << rate(parseMs) << ", "
+        << QString::number(megabytesPerSecond(csv.size(), qint64(parseMs * 1e6)), 'f', 0)
+        << " MB/s)\n";
+    out << "  store   " << rate(storeMs) << ")\n\n";
+    return 0;
+}
+
+// Swallows what it is given, so the export is timed without the disk
+class CountingDevice : public QIODevice {
+public:
+    qint64 written = 0;
+
+protected:
+    qint64 readData(char*, qint64) override { return -1; }
+    qint64 writeData(const char*, qint64 size) override {
+        written += size;
+        return size;
+    }
+};
+
+int benchmarkExport(QTextStream& out, int rows) {
+    SummaryEntries entries(syntheticSummary(rows));
+    SleepTable table = SleepTable::fromEntries(entries, QStringList());
+    CsvExporter::Options options;
+    options.symptoms = table.columnNames();
+
+    out << "CSV export, " << options.symptoms.size() << " symptom columns\n";
+    out << "rows      ms        ns/row    MB/s\n";
+    for (int count : {rows / 4, rows / 2, rows}) {
+        SleepTableView view(table, 0, count);
+        double best = 0.0;
+        qint64 bytes = 0;
+        for (int round = 0; round < 3; ++round) {
+            CountingDevice device;
+            device.open(QIODevice::WriteOnly);
+
+            QElapsedTimer timer;
+            timer.start();
+            if (!CsvExporter::write(device, view, options)) {
+                out << "the export failed\n";
+                return 1;
+            }
+            double elapsed = timer.nsecsElapsed() / 1e6;
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+            bytes = device.written;
+        }
+        out << qSetFieldWidth(10) << Qt::left << count << QString::number(best, 'f', 1)
+            << QString::number(best * 1e6 / qMax(count, 1), 'f', 0)
+            << QString::number(megabytesPerSecond(bytes, qint64(best * 1e6)), 'f', 0)
+            << qSetFieldWidth(0) << "\n";
+    }
+    out << "\n";
+    return 0;
+}
+
+int benchmarkStatistics(QTextStream& out, int rows) {
+    QList<QVariantMap> history = syntheticSummary(rows);
+    SummaryEntries entries(history);
+    SleepTable table = SleepTable::fromEntries(entries, QStringList());
+
+    // Best of three full rebuilds
+    double rebuildMs = 0.0;
+    SummaryStatistics statistics;
+    for (int round = 0; round < 3; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        statistics = SummaryStatistics::fromTable(table);
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        rebuildMs = round == 0 ? elapsed : std::min(rebuildMs, elapsed);
+    }
+
+    // Edits as a save makes them: the old entry out, the new one in
+    const int edits = 10000;
+    QRandomGenerator random(37);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < edits; ++i) {
+        int row = random.bounded(rows);
+        QVariantMap edited = history[row];
+        edited["sleep_duration"] = 6.0 + random.bounded(3.0);
+        statistics.remove(history[row]);
+        statistics.add(edited);
+        history[row] = edited;
+    }
+    double editNs = timer.nsecsElapsed() / double(edits);
+
+    // The running mean and variance must match a rebuild of the edited rows
+    SleepTable edited = SleepTable::fromEntries(SummaryEntries(history), QStringList());
+    SummaryStatistics rebuilt = SummaryStatistics::fromTable(edited);
+    const ColumnStatistics* running = statistics.column("sleep_duration");
+    const ColumnStatistics* exact = rebuilt.column("sleep_duration");
+    if (!running || !exact || running->count != exact->count
+        || qAbs(running->mean - exact->mean) > 1e-9
+        || qAbs(running->variance() - exact->variance()) > 1e-6
+        || running->min != exact->min || running->max != exact->max
+        || running->lowerQuartile() != exact->lowerQuartile()
+        || running->median() != exact->median()
+        || running->upperQuartile() != exact->upperQuartile()) {
+        out << "the updated statistics drifted from a rebuild\n";
+        return 1;
+    }
+
+    // What the summary panel reads per refresh: three quartiles per column
+    double sink = 0.0;
+    timer.start();
+    for (const QString& name : statistics.columnNames()) {
+        if (const ColumnStatistics* column = statistics.column(name)) {
+            sink += column->lowerQuartile() + column->median() + column->upperQuartile();
+        }
+    }
+    double readUs = timer.nsecsElapsed() / 1e3;
+
+    out << "summary statistics of " << rows << " entries, "
+        << statistics.columnNames().size() << " columns\n";
+    out << "  rebuild " << QString::number(rebuildMs, 'f', 2) << " ms\n";
+    out << "  edit    " << QString::number(editNs, 'f', 0) << " ns per remove and add\n";
+    out << "  read    " << QString::number(readUs, 'f', 1)
+        << " us for the quartiles of every column" << (qIsNaN(sink) ? " (empty)" : "")
+        << "\n\n";
+    return 0;
+}
+
+int benchmarkCorrelation(QTextStream& out) {
+    const int columns = 100;
+    const int rows = 3653;
+
+    // Each column partly follows the one before, so coefficients vary
+    QRandomGenerator random(41);
+    QVector<QVector<double>> values(columns, QVector<double>(rows));
+    for (int c = 0; c < columns; ++c) {
+        for (int row = 0; row < rows; ++row) {
+            double noise = double(random.bounded(5));
+            values[c][row] = c > 0 && random.bounded(2) ? values[c - 1][row] : noise;
+        }
+    }
+    QVector<const double*> series;
+    for (const QVector<double>& column : values) {
+        series.append(column.constData());
+    }
+
+    // Direct two-pass Pearson of one pair as a check on the blocked kernel
+    const double* x = series[0];
+    const double* y = series[1];
+    double meanX = std::accumulate(x, x + rows, 0.0) / rows;
+    double meanY = std::accumulate(y, y + rows, 0.0) / rows;
+    double xy = 0.0, xx = 0.0, yy = 0.0;
+    for (int row = 0; row < rows; ++row) {
+        xy += (x[row] - meanX) * (y[row] - meanY);
+        xx += (x[row] - meanX) * (x[row] - meanX);
+        yy += (y[row] - meanY) * (y[row] - meanY);
+    }
+    double expected = xy / std::sqrt(xx * yy);
+
+    out << "correlation of " << columns << " columns over " << rows << " nights, "
+        << QThreadPool::globalInstance()->maxThreadCount() << " threads\n";
+    for (auto method : {CorrelationMatrix::Method::Pearson, CorrelationMatrix::Method::Spearman}) {
+        double best = 0.0;
+        CorrelationMatrix matrix;
+        for (int round = 0; round < 3; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            matrix = CorrelationMatrix::compute(series, rows, method);
+            double elapsed = timer.nsecsElapsed() / 1e6;
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        if (method == CorrelationMatrix::Method::Pearson
+            && qAbs(matrix.at(0, 1) - expected) > 1e-9) {
+            out << "the correlation matrix disagrees with a direct computation\n";
+            return 1;
+        }
+        out << (method == CorrelationMatrix::Method::Pearson ? "  pearson  " : "  spearman ")
+            << QString::number(best, 'f', 2) << " ms\n";
+    }
+    out << "\n";
+    return 0;
+}
+
+int benchmarkLag(QTextStream& out) {
+    const int days = 3653;
+    const int symptoms = 8;
+
+    // Sleep follows the first symptom two days later; one day in eight has
+    // no entry and some symptoms were not recorded on others
+    QRandomGenerator random(43);
+    QVector<DailySeries> causes(symptoms);
+    DailySeries effect;
+    effect.values.fill(0.0, days);
+    effect.present.fill(0, days);
+    for (DailySeries& cause : causes) {
+        cause.values.fill(0.0, days);
+        cause.present.fill(0, days);
+        for (int day = 0; day < days; ++day) {
+            cause.values[day] = double(random.bounded(5));
+            cause.present[day] = random.bounded(10) != 0;
+        }
+    }
+    for (int day = 0; day < days; ++day) {
+        double lagged = day >= 2 ? causes[0].values[day - 2] : 0.0;
+        effect.values[day] = 6.0 + 0.5 * lagged + random.bounded(2.0);
+        effect.present[day] = random.bounded(8) != 0;
+    }
+
+    out << "lagged correlation of " << symptoms << " symptoms over " << days << " days\n";
+    for (int reach : {14, 365}) {
+        double best = 0.0;
+        QVector<LaggedCorrelation::Curve> curves;
+        for (int round = 0; round < 3; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            curves = LaggedCorrelation::compute(causes, effect, -reach, reach);
+            double elapsed = timer.nsecsElapsed() / 1e6;
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        double atTwo = curves[0].coefficients[reach + 2];
+        if (!(atTwo > 0.3)) {
+            out << "the lagged correlation missed the planted two-day lag\n";
+            return 1;
+        }
+        out << "  lags -" << reach << ".." << reach << "  " << QString::number(best, 'f', 2)
+            << " ms, r at lag 2 " << QString::number(atTwo, 'f', 3) << "\n";
+    }
+    out << "\n";
+    return 0;
+}
+
+int benchmarkRollup(QTextStream& out, int rows) {
+    SummaryEntries entries(syntheticSummary(rows));
+    SleepTable table = SleepTable::fromEntries(entries, QStringList());
+    QStringList columns = table.columnNames();
+    columns.prepend("sleep_duration");
+
+    double best = 0.0;
+    RollupPyramid pyramid;
+    for (int round = 0; round < 3; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        pyramid = RollupPyramid::build(table.all(), columns);
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        best = round == 0 ? elapsed : std::min(best, elapsed);
+    }
+    if (pyramid.bucketCount(RollupPyramid::Day) != rows) {
+        out << "the rollup lost nights\n";
+        return 1;
+    }
+
+    out << "rollup of " << rows << " nights, " << columns.size() << " columns: build "
+        << QString::number(best, 'f', 2) << " ms\n";
+    out << "level      buckets   us per column read\n";
+    QVector<double> keys, values;
+    for (int level = 0; level < RollupPyramid::LevelCount; ++level) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int c = 0; c < columns.size(); ++c) {
+            pyramid.series(RollupPyramid::Level(level), c, RollupPyramid::Statistic::Mean, keys,
+                           values);
+        }
+        double perColumn = timer.nsecsElapsed() / 1e3 / columns.size();
+        out << qSetFieldWidth(10) << Qt::left
+            << RollupPyramid::levelName(RollupPyramid::Level(level))
+            << pyramid.bucketCount(RollupPyramid::Level(level))
+            << QString::number(perColumn, 'f', 1) << qSetFieldWidth(0) << "\n";
+    }
+    out << "\n";
+    return 0;
+}
+
+int benchmarkRegression(QTextStream& out, int rows) {
+    const int symptoms = 20;
+    const int window = qMin(rows, 365);
+
+    // Sleep shortens with the first half of the symptoms and lengthens with
+    // the second, on top of noise
+    QRandomGenerator random(47);
+    QVector<QVector<double>> columns(symptoms, QVector<double>(rows));
+    QVector<double> planted(symptoms), duration(rows);
+    for (int c = 0; c < symptoms; ++c) {
+        planted[c] = (c < symptoms / 2 ? -0.1 : 0.05) * (c % 5 + 1);
+    }
+    for (int row = 0; row < rows; ++row) {
+        double sleep = 7.0 + random.bounded(1.0);
+        for (int c = 0; c < symptoms; ++c) {
+            columns[c][row] = double(random.bounded(6));
+            sleep += planted[c] * columns[c][row];
+        }
+        duration[row] = sleep;
+    }
+    QVector<const double*> predictors;
+    for (const QVector<double>& column : qAsConst(columns)) {
+        predictors.append(column.constData());
+    }
+
+    out << "regression of sleep duration on " << symptoms << " symptoms over " << rows
+        << " nights\n";
+    for (double ridge : {0.0, 0.1}) {
+        double best = 0.0;
+        LinearRegression::Result fit;
+        for (int round = 0; round < 3; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            fit = LinearRegression::fit(predictors, duration.constData(), rows, ridge);
+            double elapsed = timer.nsecsElapsed() / 1e3;
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        if (!fit.ok) {
+            out << "the regression failed: " << fit.error << "\n";
+            return 1;
+        }
+        if (ridge == 0.0) {
+            for (int c = 0; c < symptoms; ++c) {
+                if (std::abs(fit.coefficients[c] - planted[c]) > 4.0 * fit.standardErrors[c]) {
+                    out << "the regression missed the planted coefficient of symptom " << c
+                        << "\n";
+                    return 1;
+                }
+            }
+        }
+
+        // A year-long window stepped a week at a time, as while dragging
+        // the date range
+        int fits = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int first = 0; first + window <= rows; first += 7) {
+            QVector<const double*> shifted;
+            for (const double* column : qAsConst(predictors)) {
+                shifted.append(column + first);
+            }
+            LinearRegression::fit(shifted, duration.constData() + first, window, ridge);
+            ++fits;
+        }
+        double perWindow = timer.nsecsElapsed() / 1e3 / qMax(1, fits);
+
+        out << "  ridge " << QString::number(ridge, 'f', 1) << "  whole history "
+            << QString::number(best, 'f', 1) << " us, R2 " << QString::number(fit.rSquared, 'f', 3)
+            << "; " << window << "-night window " << QString::number(perWindow, 'f', 1)
+            << " us per fit\n";
+    }
+    out << "\n";
+    return 0;
+}
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    int i = args.indexOf("--only");
+    QString only = i >= 0 && i + 1 < args.size() ? args[i + 1] : QString();
+
+    int result = 0;
+    if (result == 0 && (only.isEmpty() || only == "kdf")) {
+        result = benchmarkKeyDerivation(out);
+    }
+    if (result == 0 && (only.isEmpty() || only == "keystream")) {
+        result = benchmarkKeystream(out, intArgument(args, "--megabytes", 256));
+    }
+    if (result == 0 && (only.isEmpty() || only == "cipher")) {
+        result = benchmarkCipher(out, intArgument(args, "--megabytes", 256));
+    }
+    if (result == 0 && (only.isEmpty() || only == "records")) {
+        result = benchmarkRecords(out, intArgument(args, "--records", 5000));
+    }
+    if (result == 0 && (only.isEmpty() || only == "compression")) {
+        result = benchmarkCompression(out, intArgument(args, "--records", 5000));
+    }
+    if (result == 0 && (only.isEmpty() || only == "read")) {
+        result = benchmarkDetailRead(out, intArgument(args, "--records", 5000),
+                                     intArgument(args, "--notes-bytes", 1500));
+    }
+    if (result == 0 && (only.isEmpty() || only == "commit")) {
+        result = benchmarkCommit(out, intArgument(args, "--saves", 200));
+    }
+    if (result == 0 && (only.isEmpty() || only == "reindex")) {
+        result = benchmarkReindex(out, intArgument(args, "--records", 5000),
+                                  intArgument(args, "--notes-bytes", 1500));
+    }
+    if (result == 0 && (only.isEmpty() || only == "import")) {
+        result = benchmarkImport(out, intArgument(args, "--rows", 200000),
+                                 intArgument(args, "--notes-bytes", 60));
+    }
+    if (result == 0 && (only.isEmpty() || only == "export")) {
+        result = benchmarkExport(out, intArgument(args, "--rows", 200000));
+    }
+    if (result == 0 && (only.isEmpty() || only == "statistics")) {
+        result = benchmarkStatistics(out, intArgument(args, "--rows", 200000));
+    }
+    if (result == 0 && (only.isEmpty() || only == "correlation")) {
+        result = benchmarkCorrelation(out);
+    }
+    if (result == 0 && (only.isEmpty() || only == "lag")) {
+        result = benchmarkLag(out);
+    }
+    if (result == 0 && (only.isEmpty() || only == "rollup")) {
+        result = benchmarkRollup(out, intArgument(args, "--records", 3653));
+    }
+    if (result == 0 && (only.isEmpty() || only == "regression")) {
+        result = benchmarkRegression(out, intArgument(args, "--records", 3653));
+    }
+    return result;
+}
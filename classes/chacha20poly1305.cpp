@@ -0,0 +1,363 @@
+//created by drmrsthemonarch with ai effort
+#include "chacha20poly1305.h"
+#include <QtEndian>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SLEEPBOOK_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Cipher and MAC alternate over pieces of this size while they are still
+// in L1; a multiple of the 64-byte block so no keystream is wasted
+const qint64 PassSize = 16 * 1024;
+
+inline quint32 load32(const uchar* p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+inline quint32 rotl(quint32 v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+inline void quarterRound(quint32& a, quint32& b, quint32& c, quint32& d) {
+    a += b; d = rotl(d ^ a, 16);
+    c += d; b = rotl(b ^ c, 12);
+    a += b; d = rotl(d ^ a, 8);
+    c += d; b = rotl(b ^ c, 7);
+}
+
+void initState(quint32* state, const uchar* key, const uchar* nonce, quint32 counter) {
+    state[0] = 0x61707865; // "expand 32-byte k"
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; ++i) {
+        state[4 + i] = load32(key + 4 * i);
+    }
+    state[12] = counter;
+    for (int i = 0; i < 3; ++i) {
+        state[13 + i] = load32(nonce + 4 * i);
+    }
+}
+
+// One keystream block; advances the block counter
+void chachaBlock(quint32* state, uchar* out) {
+    quint32 x[16];
+    std::memcpy(x, state, sizeof(x));
+    for (int round = 0; round < 10; ++round) {
+        quarterRound(x[0], x[4], x[8], x[12]);
+        quarterRound(x[1], x[5], x[9], x[13]);
+        quarterRound(x[2], x[6], x[10], x[14]);
+        quarterRound(x[3], x[7], x[11], x[15]);
+        quarterRound(x[0], x[5], x[10], x[15]);
+        quarterRound(x[1], x[6], x[11], x[12]);
+        quarterRound(x[2], x[7], x[8], x[13]);
+        quarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; ++i) {
+        qToLittleEndian(x[i] + state[i], out + 4 * i);
+    }
+    ++state[12];
+}
+
+void xorBytes(uchar* data, const uchar* keystream, qint64 size) {
+    qint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 a, b;
+        std::memcpy(&a, data + i, 8);
+        std::memcpy(&b, keystream + i, 8);
+        a ^= b;
+        std::memcpy(data + i, &a, 8);
+    }
+    for (; i < size; ++i) {
+        data[i] ^= keystream[i];
+    }
+}
+
+#ifdef SLEEPBOOK_HAVE_SSE2
+template <int N>
+inline __m128i rotl4(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi32(v, N), _mm_srli_epi32(v, 32 - N));
+}
+
+inline void quarterRound4(__m128i& a, __m128i& b, __m128i& c, __m128i& d) {
+    a = _mm_add_epi32(a, b); d = rotl4<16>(_mm_xor_si128(d, a));
+    c = _mm_add_epi32(c, d); b = rotl4<12>(_mm_xor_si128(b, c));
+    a = _mm_add_epi32(a, b); d = rotl4<8>(_mm_xor_si128(d, a));
+    c = _mm_add_epi32(c, d); b = rotl4<7>(_mm_xor_si128(b, c));
+}
+
+// Four consecutive blocks, one per SSE lane, XORed into 256 bytes of data
+void chachaBlocks4(quint32* state, uchar* data) {
+    __m128i x[16], initial[16];
+    for (int i = 0; i < 16; ++i) {
+        initial[i] = _mm_set1_epi32(int(state[i]));
+    }
+    initial[12] = _mm_add_epi32(initial[12], _mm_set_epi32(3, 2, 1, 0));
+    for (int i = 0; i < 16; ++i) {
+        x[i] = initial[i];
+    }
+
+    for (int round = 0; round < 10; ++round) {
+        quarterRound4(x[0], x[4], x[8], x[12]);
+        quarterRound4(x[1], x[5], x[9], x[13]);
+        quarterRound4(x[2], x[6], x[10], x[14]);
+        quarterRound4(x[3], x[7], x[11], x[15]);
+        quarterRound4(x[0], x[5], x[10], x[15]);
+        quarterRound4(x[1], x[6], x[11], x[12]);
+        quarterRound4(x[2], x[7], x[8], x[13]);
+        quarterRound4(x[3], x[4], x[9], x[14]);
+    }
+
+    // Lane j of words 4g..4g+3 is bytes 16g..16g+15 of block j
+    for (int g = 0; g < 4; ++g) {
+        __m128i a0 = _mm_add_epi32(x[4 * g], initial[4 * g]);
+        __m128i a1 = _mm_add_epi32(x[4 * g + 1], initial[4 * g + 1]);
+        __m128i a2 = _mm_add_epi32(x[4 * g + 2], initial[4 * g + 2]);
+        __m128i a3 = _mm_add_epi32(x[4 * g + 3], initial[4 * g + 3]);
+
+        __m128i t0 = _mm_unpacklo_epi32(a0, a1);
+        __m128i t1 = _mm_unpacklo_epi32(a2, a3);
+        __m128i t2 = _mm_unpackhi_epi32(a0, a1);
+        __m128i t3 = _mm_unpackhi_epi32(a2, a3);
+        __m128i lanes[4] = {_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                            _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+
+        for (int j = 0; j < 4; ++j) {
+            __m128i* p = reinterpret_cast<__m128i*>(data + 64 * j + 16 * g);
+            _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), lanes[j]));
+        }
+    }
+    state[12] += 4;
+}
+#endif
+
+// XORs the keystream into data, continuing from the counter in state.
+// Only the last call for a message may end part way through a block.
+void applyChaCha(quint32* state, uchar* data, qint64 size) {
+#ifdef SLEEPBOOK_HAVE_SSE2
+    for (; size >= 256; data += 256, size -= 256) {
+        chachaBlocks4(state, data);
+    }
+#endif
+    uchar block[64];
+    for (; size > 0; data += 64, size -= 64) {
+        chachaBlock(state, block);
+        xorBytes(data, block, qMin<qint64>(size, 64));
+    }
+}
+
+// Poly1305 over 26-bit limbs; 64-bit products never overflow
+class Poly1305 {
+public:
+    explicit Poly1305(const uchar* key) : m_buffered(0) {
+        m_r[0] = load32(key + 0) & 0x3ffffff;
+        m_r[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+        m_r[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+        m_r[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+        m_r[4] = (load32(key + 12) >> 8) & 0x00fffff;
+        for (int i = 0; i < 4; ++i) {
+            m_pad[i] = load32(key + 16 + 4 * i);
+        }
+        std::memset(m_h, 0, sizeof(m_h));
+    }
+
+    void update(const uchar* data, qint64 size) {
+        if (size <= 0) {
+            return;
+        }
+        if (m_buffered > 0) {
+            int take = int(qMin<qint64>(16 - m_buffered, size));
+            std::memcpy(m_buffer + m_buffered, data, take);
+            m_buffered += take;
+            data += take;
+            size -= take;
+            if (m_buffered < 16) {
+                return;
+            }
+            blocks(m_buffer, 16, 1 << 24);
+            m_buffered = 0;
+        }
+        qint64 full = size & ~qint64(15);
+        if (full > 0) {
+            blocks(data, full, 1 << 24);
+        }
+        if (size > full) {
+            m_buffered = int(size - full);
+            std::memcpy(m_buffer, data + full, m_buffered);
+        }
+    }
+
+    // Zero padding to a block boundary, as the AEAD construction requires
+    void padToBlock() {
+        if (m_buffered > 0) {
+            std::memset(m_buffer + m_buffered, 0, 16 - m_buffered);
+            blocks(m_buffer, 16, 1 << 24);
+            m_buffered = 0;
+        }
+    }
+
+    void finish(uchar* tag) {
+        if (m_buffered > 0) {
+            m_buffer[m_buffered] = 1;
+            std::memset(m_buffer + m_buffered + 1, 0, 15 - m_buffered);
+            blocks(m_buffer, 16, 0);
+        }
+
+        quint32 h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+        quint32 c;
+        c = h1 >> 26; h1 &= 0x3ffffff;
+        h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+        h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+        h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+
+        // h - p, kept only if it did not go negative
+        quint32 g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+        quint32 g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+        quint32 g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+        quint32 g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+        quint32 g4 = h4 + c - (1u << 26);
+
+        quint32 mask = (g4 >> 31) - 1;
+        h0 = (h0 & ~mask) | (g0 & mask);
+        h1 = (h1 & ~mask) | (g1 & mask);
+        h2 = (h2 & ~mask) | (g2 & mask);
+        h3 = (h3 & ~mask) | (g3 & mask);
+        h4 = (h4 & ~mask) | (g4 & mask);
+
+        // Back to 4 x 32 bits, then add the pad mod 2^128
+        quint32 w0 = h0 | (h1 << 26);
+        quint32 w1 = (h1 >> 6) | (h2 << 20);
+        quint32 w2 = (h2 >> 12) | (h3 << 14);
+        quint32 w3 = (h3 >> 18) | (h4 << 8);
+
+        quint64 f = quint64(w0) + m_pad[0];
+        qToLittleEndian(quint32(f), tag);
+        f = quint64(w1) + m_pad[1] + (f >> 32);
+        qToLittleEndian(quint32(f), tag + 4);
+        f = quint64(w2) + m_pad[2] + (f >> 32);
+        qToLittleEndian(quint32(f), tag + 8);
+        f = quint64(w3) + m_pad[3] + (f >> 32);
+        qToLittleEndian(quint32(f), tag + 12);
+    }
+
+private:
+    void blocks(const uchar* data, qint64 size, quint32 hibit) {
+        const quint64 r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+        const quint64 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+        quint32 h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+
+        for (; size >= 16; data += 16, size -= 16) {
+            h0 += load32(data + 0) & 0x3ffffff;
+            h1 += (load32(data + 3) >> 2) & 0x3ffffff;
+            h2 += (load32(data + 6) >> 4) & 0x3ffffff;
+            h3 += (load32(data + 9) >> 6) & 0x3ffffff;
+            h4 += (load32(data + 12) >> 8) | hibit;
+
+            quint64 d0 = h0 * r0 + h1 * s4 + h2 * s3 + h3 * s2 + h4 * s1;
+            quint64 d1 = h0 * r1 + h1 * r0 + h2 * s4 + h3 * s3 + h4 * s2;
+            quint64 d2 = h0 * r2 + h1 * r1 + h2 * r0 + h3 * s4 + h4 * s3;
+            quint64 d3 = h0 * r3 + h1 * r2 + h2 * r1 + h3 * r0 + h4 * s4;
+            quint64 d4 = h0 * r4 + h1 * r3 + h2 * r2 + h3 * r1 + h4 * r0;
+
+            quint32 c;
+            c = quint32(d0 >> 26); h0 = quint32(d0) & 0x3ffffff;
+            d1 += c; c = quint32(d1 >> 26); h1 = quint32(d1) & 0x3ffffff;
+            d2 += c; c = quint32(d2 >> 26); h2 = quint32(d2) & 0x3ffffff;
+            d3 += c; c = quint32(d3 >> 26); h3 = quint32(d3) & 0x3ffffff;
+            d4 += c; c = quint32(d4 >> 26); h4 = quint32(d4) & 0x3ffffff;
+            h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+            h1 += c;
+        }
+
+        m_h[0] = h0; m_h[1] = h1; m_h[2] = h2; m_h[3] = h3; m_h[4] = h4;
+    }
+
+    quint32 m_r[5];
+    quint32 m_h[5];
+    quint32 m_pad[4];
+    uchar m_buffer[16];
+    int m_buffered;
+};
+
+// Poly1305 key from block 0; the state is left at block 1 for the payload
+Poly1305 startMessage(quint32* state, const uchar* key, const uchar* nonce,
+                      const uchar* aad, qint64 aadSize) {
+    initState(state, key, nonce, 0);
+    uchar block[64];
+    chachaBlock(state, block);
+    Poly1305 mac(block);
+    mac.update(aad, aadSize);
+    mac.padToBlock();
+    return mac;
+}
+
+void finishMessage(Poly1305& mac, qint64 aadSize, qint64 size, uchar* tag) {
+    mac.padToBlock();
+    uchar lengths[16];
+    qToLittleEndian(quint64(aadSize), lengths);
+    qToLittleEndian(quint64(size), lengths + 8);
+    mac.update(lengths, 16);
+    mac.finish(tag);
+}
+}
+
+void ChaCha20Poly1305::seal(const uchar* key, const uchar* nonce, const uchar* aad,
+                            qint64 aadSize, char* data, qint64 size, uchar* tag) {
+    quint32 state[16];
+    Poly1305 mac = startMessage(state, key, nonce, aad, aadSize);
+
+    uchar* p = reinterpret_cast<uchar*>(data);
+    for (qint64 done = 0; done < size; done += PassSize) {
+        qint64 n = qMin(PassSize, size - done);
+        applyChaCha(state, p + done, n);
+        mac.update(p + done, n);
+    }
+    finishMessage(mac, aadSize, size, tag);
+}
+
+bool ChaCha20Poly1305::open(const uchar* key, const uchar* nonce, const uchar* aad,
+                            qint64 aadSize, char* data, qint64 size, const uchar* tag) {
+    quint32 state[16];
+    Poly1305 mac = startMessage(state, key, nonce, aad, aadSize);
+
+    uchar* p = reinterpret_cast<uchar*>(data);
+    for (qint64 done = 0; done < size; done += PassSize) {
+        qint64 n = qMin(PassSize, size - done);
+        mac.update(p + done, n);
+        applyChaCha(state, p + done, n);
+    }
+
+    uchar expected[TagSize];
+    finishMessage(mac, aadSize, size, expected);
+
+    // Constant time, so a forger learns nothing from how long this takes
+    uchar difference = 0;
+    for (int i = 0; i < TagSize; ++i) {
+        difference |= expected[i] ^ tag[i];
+    }
+    if (difference != 0) {
+        if (size > 0) {
+            std::memset(data, 0, size_t(size));
+        }
+        return false;
+    }
+    return true;
+}
+
+void ChaCha20Poly1305::xorKeystream(const uchar* key, const uchar* nonce, quint32 counter,
+                                    char* data, qint64 size) {
+    quint32 state[16];
+    initState(state, key, nonce, counter);
+    applyChaCha(state, reinterpret_cast<uchar*>(data), size);
+}
+
+void ChaCha20Poly1305::poly1305(const uchar* key, const uchar* data, qint64 size, uchar* tag) {
+    Poly1305 mac(key);
+    mac.update(data, size);
+    mac.finish(tag);
+}
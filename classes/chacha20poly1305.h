@@ -0,0 +1,34 @@
+//created by drmrsthemonarch with ai effort
+#ifndef CHACHA20POLY1305_H
+#define CHACHA20POLY1305_H
+
+#include <QtGlobal>
+
+// ChaCha20-Poly1305 authenticated encryption (RFC 8439).
+// Works in place on the caller's buffer. ChaCha20 runs four blocks at a
+// time in SSE2 registers where available and one block at a time
+// otherwise; Poly1305 uses portable 26-bit limbs. The MAC and the cipher
+// share one pass over the data, a few KiB at a time, so each byte is
+// loaded from memory once.
+class ChaCha20Poly1305 {
+public:
+    static const int KeySize = 32;
+    static const int NonceSize = 12;
+    static const int TagSize = 16;
+
+    // Encrypts size bytes at data in place and writes the tag
+    static void seal(const uchar* key, const uchar* nonce, const uchar* aad, qint64 aadSize,
+                     char* data, qint64 size, uchar* tag);
+    // Decrypts in place if the tag matches; otherwise zeroes data and
+    // returns false
+    static bool open(const uchar* key, const uchar* nonce, const uchar* aad, qint64 aadSize,
+                     char* data, qint64 size, const uchar* tag);
+
+    // Raw ChaCha20 keystream XOR starting at the given block counter
+    static void xorKeystream(const uchar* key, const uchar* nonce, quint32 counter,
+                             char* data, qint64 size);
+    // One-shot Poly1305 with a 32-byte one-time key
+    static void poly1305(const uchar* key, const uchar* data, qint64 size, uchar* tag);
+};
+
+#endif // CHACHA20POLY1305_H
@@ -0,0 +1,195 @@
+//created by drmrsthemonarch with ai effort
+#include "correlationmatrix.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SLEEPBOOK_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Series per tile side; two tiles' worth of RowBlock slices (512 KiB)
+// stay in L2 while every pair between them is accumulated
+const int Tile = 16;
+// Values of each series per pass over a tile pair
+const int RowBlock = 2048;
+
+// A series whose spread is below this, relative to its largest value, is
+// constant up to rounding and has no correlation
+const double ConstantTolerance = 1e-12;
+
+// 1-based ranks; tied values share the mean of the positions they span
+void rankInPlace(double* values, int rows) {
+    QVector<int> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [values](int a, int b) { return values[a] < values[b]; });
+
+    QVector<double> ranks(rows);
+    for (int first = 0; first < rows;) {
+        int last = first + 1;
+        while (last < rows && values[order[last]] == values[order[first]]) {
+            ++last;
+        }
+        double rank = (first + 1 + last) / 2.0;
+        for (int i = first; i < last; ++i) {
+            ranks[order[i]] = rank;
+        }
+        first = last;
+    }
+    std::copy(ranks.constBegin(), ranks.constEnd(), values);
+}
+
+// Centres the series on its mean and scales it to unit length, so that
+// the dot product of two series is their Pearson coefficient. Returns
+// false, leaving zeros, if the series is constant.
+bool standardize(double* values, int rows) {
+    double mean = std::accumulate(values, values + rows, 0.0) / rows;
+    double largest = 0.0;
+    double squares = 0.0;
+    for (int i = 0; i < rows; ++i) {
+        largest = qMax(largest, std::fabs(values[i]));
+        values[i] -= mean;
+        squares += values[i] * values[i];
+    }
+    double floor = largest * ConstantTolerance;
+    if (!(squares > rows * floor * floor)) {
+        std::fill(values, values + rows, 0.0);
+        return false;
+    }
+    double scale = 1.0 / std::sqrt(squares);
+    for (int i = 0; i < rows; ++i) {
+        values[i] *= scale;
+    }
+    return true;
+}
+
+// Adds a0.b0, a0.b1, a1.b0 and a1.b1 over length values (even) to out
+inline void dot2x2(const double* a0, const double* a1, const double* b0, const double* b1,
+                   int length, double* out) {
+#ifdef SLEEPBOOK_HAVE_SSE2
+    __m128d s00 = _mm_setzero_pd(), s01 = _mm_setzero_pd();
+    __m128d s10 = _mm_setzero_pd(), s11 = _mm_setzero_pd();
+    for (int k = 0; k < length; k += 2) {
+        __m128d x0 = _mm_loadu_pd(a0 + k);
+        __m128d x1 = _mm_loadu_pd(a1 + k);
+        __m128d y0 = _mm_loadu_pd(b0 + k);
+        __m128d y1 = _mm_loadu_pd(b1 + k);
+        s00 = _mm_add_pd(s00, _mm_mul_pd(x0, y0));
+        s01 = _mm_add_pd(s01, _mm_mul_pd(x0, y1));
+        s10 = _mm_add_pd(s10, _mm_mul_pd(x1, y0));
+        s11 = _mm_add_pd(s11, _mm_mul_pd(x1, y1));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, s00);
+    out[0] += lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, s01);
+    out[1] += lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, s10);
+    out[2] += lanes[0] + lanes[1];
+    _mm_storeu_pd(lanes, s11);
+    out[3] += lanes[0] + lanes[1];
+#else
+    double s00 = 0.0, s01 = 0.0, s10 = 0.0, s11 = 0.0;
+    for (int k = 0; k < length; ++k) {
+        s00 += a0[k] * b0[k];
+        s01 += a0[k] * b1[k];
+        s10 += a1[k] * b0[k];
+        s11 += a1[k] * b1[k];
+    }
+    out[0] += s00;
+    out[1] += s01;
+    out[2] += s10;
+    out[3] += s11;
+#endif
+}
+}
+
+CorrelationMatrix CorrelationMatrix::compute(const QVector<const double*>& series, int rows,
+                                             Method method) {
+    CorrelationMatrix matrix;
+    const int size = series.size();
+    matrix.m_size = size;
+    matrix.m_observations = rows;
+    matrix.m_values = QVector<double>(size * size, std::numeric_limits<double>::quiet_NaN());
+    if (size == 0 || rows < 2) {
+        return matrix;
+    }
+
+    // Z: one row per series, padded with zero values and a zero series to
+    // even sizes so the kernel never needs a remainder
+    const int stride = (rows + 1) & ~1;
+    const int paddedSize = (size + 1) & ~1;
+    QVector<double> z(paddedSize * stride, 0.0);
+    QVector<char> varies(size, 0);
+    double* zData = z.data();
+    char* variesData = varies.data();
+
+    QVector<int> indexes(size);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&series, rows, stride, method, zData,
+                                        variesData](int& i) {
+        double* row = zData + qint64(i) * stride;
+        if (series[i]) {
+            std::copy(series[i], series[i] + rows, row);
+        }
+        if (method == Method::Spearman) {
+            rankInPlace(row, rows);
+        }
+        variesData[i] = standardize(row, rows);
+    });
+
+    // Upper triangle of tile pairs; each fills its cells in both halves,
+    // and no two share a cell
+    const int tiles = (paddedSize + Tile - 1) / Tile;
+    QVector<QPair<int, int>> tilePairs;
+    for (int ti = 0; ti < tiles; ++ti) {
+        for (int tj = ti; tj < tiles; ++tj) {
+            tilePairs.append(qMakePair(ti, tj));
+        }
+    }
+
+    double* values = matrix.m_values.data();
+    QtConcurrent::blockingMap(tilePairs, [=](QPair<int, int>& tile) {
+        const int iBegin = tile.first * Tile;
+        const int iEnd = qMin(iBegin + Tile, paddedSize);
+        const int jBegin = tile.second * Tile;
+        const int jEnd = qMin(jBegin + Tile, paddedSize);
+
+        double sums[Tile * Tile] = {};
+        for (int k = 0; k < stride; k += RowBlock) {
+            const int length = qMin(RowBlock, stride - k);
+            for (int i = iBegin; i < iEnd; i += 2) {
+                const double* a0 = zData + qint64(i) * stride + k;
+                const double* a1 = a0 + stride;
+                for (int j = qMax(jBegin, i); j < jEnd; j += 2) {
+                    const double* b0 = zData + qint64(j) * stride + k;
+                    double block[4] = {};
+                    dot2x2(a0, a1, b0, b0 + stride, length, block);
+                    double* cell = sums + (i - iBegin) * Tile + (j - jBegin);
+                    cell[0] += block[0];
+                    cell[1] += block[1];
+                    cell[Tile] += block[2];
+                    cell[Tile + 1] += block[3];
+                }
+            }
+        }
+
+        for (int i = iBegin; i < qMin(iEnd, size); ++i) {
+            for (int j = qMax(jBegin, i); j < qMin(jEnd, size); ++j) {
+                double value = std::numeric_limits<double>::quiet_NaN();
+                if (variesData[i] && variesData[j]) {
+                    value = i == j ? 1.0
+                                   : qBound(-1.0, sums[(i - iBegin) * Tile + (j - jBegin)], 1.0);
+                }
+                values[i * size + j] = value;
+                values[j * size + i] = value;
+            }
+        }
+    });
+    return matrix;
+}
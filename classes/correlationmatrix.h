@@ -0,0 +1,31 @@
+//created by drmrsthemonarch with ai effort
+#ifndef CORRELATIONMATRIX_H
+#define CORRELATIONMATRIX_H
+
+#include <QVector>
+
+// All-pairs correlation of a set of equally long series. Each series is
+// standardized once (ranked first for Spearman) into a padded row of a
+// matrix Z, after which every coefficient is one dot product of Z Z^T.
+// Those are computed in cache-sized tiles, two rows against two rows per
+// SIMD step, with tiles spread over the thread pool.
+class CorrelationMatrix {
+public:
+    enum class Method { Pearson, Spearman };
+
+    // A null series reads as all zeros
+    static CorrelationMatrix compute(const QVector<const double*>& series, int rows,
+                                     Method method);
+
+    int size() const { return m_size; }
+    int observations() const { return m_observations; }
+    // NaN if either series is constant over the rows
+    double at(int row, int column) const { return m_values[row * m_size + column]; }
+
+private:
+    int m_size = 0;
+    int m_observations = 0;
+    QVector<double> m_values;
+};
+
+#endif // CORRELATIONMATRIX_H
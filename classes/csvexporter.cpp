@@ -0,0 +1,231 @@
+//created by drmrsthemonarch with ai effort
+#include "csvexporter.h"
+#include <QLocale>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Bytes formatted before each write to the device
+const int BufferSize = 256 * 1024;
+// Longest row cell: a shortest-form double or a UUID
+const int MaxCellSize = 40;
+
+// Values with up to this many decimals take the integer path
+const double FastScale = 1000.0;
+const int FastDecimals = 3;
+const double FastLimit = 1e12;
+
+const char Hex[] = "0123456789abcdef";
+
+class BufferedWriter {
+public:
+    // rowSize is the most a single reserve() asks for
+    BufferedWriter(QIODevice& device, int rowSize) : m_device(device), m_used(0), m_ok(true) {
+        m_buffer.resize(qMax(BufferSize, rowSize));
+    }
+
+    // Room for size more bytes, writing out what is buffered if needed
+    char* reserve(int size) {
+        if (m_used + size > m_buffer.size()) {
+            flush();
+        }
+        return m_buffer.data() + m_used;
+    }
+    void commit(int size) { m_used += size; }
+
+    void put(char c) {
+        *reserve(1) = c;
+        ++m_used;
+    }
+    void put(const QByteArray& bytes) {
+        if (bytes.size() > m_buffer.size() - m_used) {
+            flush();
+        }
+        if (bytes.size() > m_buffer.size()) {
+            m_ok = m_ok && m_device.write(bytes) == bytes.size();
+            return;
+        }
+        std::memcpy(m_buffer.data() + m_used, bytes.constData(), size_t(bytes.size()));
+        m_used += bytes.size();
+    }
+
+    bool flush() {
+        if (m_used > 0) {
+            m_ok = m_ok && m_device.write(m_buffer.constData(), m_used) == m_used;
+            m_used = 0;
+        }
+        return m_ok;
+    }
+
+private:
+    QIODevice& m_device;
+    QByteArray m_buffer;
+    int m_used;
+    bool m_ok;
+};
+
+// Digits of value, most significant first; returns the count
+int formatUnsigned(quint64 value, char* out) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (int i = 0; i < count; ++i) {
+        out[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+void formatPadded(int value, int width, char* out) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = char('0' + value % 10);
+        value /= 10;
+    }
+}
+
+int formatDate(qint64 julianDay, char* out) {
+    int year, month, day;
+    QDate date = QDate::fromJulianDay(julianDay);
+    date.getDate(&year, &month, &day);
+    if (year < 0 || year > 9999) {
+        QByteArray text = date.toString("yyyy-MM-dd").toLatin1();
+        int size = qMin(text.size(), MaxCellSize);
+        std::memcpy(out, text.constData(), size_t(size));
+        return size;
+    }
+    formatPadded(year, 4, out);
+    out[4] = '-';
+    formatPadded(month, 2, out + 5);
+    out[7] = '-';
+    formatPadded(day, 2, out + 8);
+    return 10;
+}
+
+// Same text as QUuid::toString(QUuid::WithoutBraces)
+int formatId(const QUuid& id, char* out) {
+    auto hex = [&out](quint64 value, int digits) {
+        for (int i = digits - 1; i >= 0; --i) {
+            *out++ = Hex[(value >> (4 * i)) & 0xF];
+        }
+    };
+    hex(id.data1, 8);
+    *out++ = '-';
+    hex(id.data2, 4);
+    *out++ = '-';
+    hex(id.data3, 4);
+    *out++ = '-';
+    hex(id.data4[0], 2);
+    hex(id.data4[1], 2);
+    *out++ = '-';
+    for (int i = 2; i < 8; ++i) {
+        hex(id.data4[i], 2);
+    }
+    return 36;
+}
+
+QByteArray headerFor(const QString& field) {
+    QString header = field;
+    header.replace("_", " ");
+    if (!header.isEmpty()) {
+        header[0] = header[0].toUpper();
+    }
+    if (header.contains(',') || header.contains('"') || header.contains('\n')) {
+        header = "\"" + header.replace("\"", "\"\"") + "\"";
+    }
+    return header.toUtf8();
+}
+}
+
+int CsvExporter::formatNumber(double value, char* out, int size) {
+    // Whole numbers and up to three decimals, which covers every symptom
+    // scale and durations in minutes: if value is exactly k / 1000 as a
+    // double, the decimal digits of k read back as the same value
+    if (std::isfinite(value) && std::fabs(value) < FastLimit && size >= 24) {
+        qint64 scaled = qint64(std::llround(value * FastScale));
+        if (double(scaled) / FastScale == value) {
+            char* p = out;
+            if (scaled < 0) {
+                *p++ = '-';
+                scaled = -scaled;
+            }
+            p += formatUnsigned(quint64(scaled) / 1000, p);
+            int fraction = int(quint64(scaled) % 1000);
+            if (fraction != 0) {
+                *p++ = '.';
+                char digits[FastDecimals];
+                formatPadded(fraction, FastDecimals, digits);
+                int used = FastDecimals;
+                while (digits[used - 1] == '0') {
+                    --used;
+                }
+                std::memcpy(p, digits, size_t(used));
+                p += used;
+            }
+            return int(p - out);
+        }
+    }
+
+    QByteArray text = QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+    if (text.size() > size) {
+        return 0;
+    }
+    std::memcpy(out, text.constData(), size_t(text.size()));
+    return text.size();
+}
+
+bool CsvExporter::write(QIODevice& device, const SleepTableView& table, const Options& options) {
+    // Schema first: every column array is looked up once, not per row
+    QStringList fields = {"date"};
+    if (options.includeId) {
+        fields << "id";
+    }
+    if (options.includeDuration) {
+        fields << "sleep_duration";
+    }
+    QVector<const double*> values;
+    QVector<int> columns;
+    for (const QString& symptom : options.symptoms) {
+        int column = table.columnIndex(symptom);
+        fields << symptom;
+        columns.append(column);
+        values.append(column >= 0 ? table.column(column) : nullptr);
+    }
+
+    // Every cell of a row fits in what is reserved for it
+    int rowSize = MaxCellSize * (fields.size() + 1);
+    BufferedWriter out(device, rowSize);
+    for (int f = 0; f < fields.size(); ++f) {
+        if (f > 0) {
+            out.put(',');
+        }
+        out.put(headerFor(fields[f]));
+    }
+    out.put('\n');
+
+    const qint64* days = table.days();
+    const double* sleepDuration = table.sleepDuration();
+    for (int row = 0; row < table.rowCount(); ++row) {
+        char* start = out.reserve(rowSize);
+        char* p = start;
+        p += formatDate(days[row], p);
+        if (options.includeId) {
+            *p++ = ',';
+            p += formatId(table.id(row), p);
+        }
+        if (options.includeDuration) {
+            *p++ = ',';
+            p += formatNumber(sleepDuration[row], p, MaxCellSize);
+        }
+        for (int c = 0; c < columns.size(); ++c) {
+            *p++ = ',';
+            if (values[c] && table.isPresent(columns[c], row)) {
+                p += formatNumber(values[c][row], p, MaxCellSize);
+            }
+        }
+        *p++ = '\n';
+        out.commit(int(p - start));
+    }
+    return out.flush();
+}
@@ -0,0 +1,34 @@
+//created by drmrsthemonarch with ai effort
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QIODevice>
+#include <QStringList>
+#include "sleeptable.h"
+
+// Writes summary history as CSV straight from the columnar table. The
+// header and the column arrays are resolved once; rows are formatted into
+// a fixed buffer that goes to the device whenever it fills, so time grows
+// linearly with the rows and memory does not grow at all. Dates, ids and
+// the usual short decimals are formatted without allocating.
+class CsvExporter {
+public:
+    struct Options {
+        bool includeId = true;
+        bool includeDuration = true;
+        // Symptom columns in output order; a name the table has no column
+        // for is written as an empty column
+        QStringList symptoms;
+    };
+
+    // Date is always the first column, then Id and Sleep duration if
+    // included, then the symptoms. A symptom a night did not record is
+    // left empty, which the importer reads back as not recorded.
+    static bool write(QIODevice& device, const SleepTableView& table, const Options& options);
+
+    // Shortest text that reads back as the same double. Returns its length,
+    // or 0 if it would not fit in size bytes.
+    static int formatNumber(double value, char* out, int size);
+};
+
+#endif // CSVEXPORTER_H
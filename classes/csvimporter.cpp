@@ -0,0 +1,417 @@
+//created by drmrsthemonarch with ai effort
+#include "csvimporter.h"
+#include <QHash>
+#include <QLatin1String>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Input is read in chunks of this size
+const int ChunkSize = 1024 * 1024;
+
+// Largest power of ten a double holds exactly
+const int MaxExactScale = 22;
+// Digits a quint64 mantissa holds without losing any
+const int MaxExactDigits = 15;
+
+// Namespace for the ids of rows that have none, so importing the same
+// file again yields the same entries rather than a second copy
+const QUuid ImportNamespace("{6f0d2c4e-9a51-4b8e-a7d3-2f1c5e8b0a94}");
+
+const double Powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+void trim(const char*& begin, const char*& end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+        --end;
+    }
+}
+
+bool isWord(const char* begin, const char* end, const char* word) {
+    int size = int(std::strlen(word));
+    return end - begin == size && qstrnicmp(begin, word, uint(size)) == 0;
+}
+
+// Plain decimals such as 7.5 or -3 are converted without a QString: up to
+// 15 significant digits over a power of ten up to 1e22 is one correctly
+// rounded division. Exponents and longer numbers go through Qt, and
+// yes/no columns read as 1 and 0.
+bool parseNumber(const char* begin, int size, double* value) {
+    const char* end = begin + size;
+    trim(begin, end);
+    if (begin == end) {
+        return false;
+    }
+
+    const char* p = begin;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        ++p;
+    }
+    quint64 mantissa = 0;
+    int significant = 0;
+    int scale = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p) {
+        mantissa = mantissa * 10 + quint64(*p - '0');
+        significant += mantissa != 0;
+        any = true;
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p) {
+            mantissa = mantissa * 10 + quint64(*p - '0');
+            significant += mantissa != 0;
+            ++scale;
+            any = true;
+        }
+    }
+    if (p == end && any && significant <= MaxExactDigits && scale <= MaxExactScale) {
+        double result = double(mantissa) / Powers[scale];
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    if (isWord(begin, end, "yes") || isWord(begin, end, "true")) {
+        *value = 1.0;
+        return true;
+    }
+    if (isWord(begin, end, "no") || isWord(begin, end, "false")) {
+        *value = 0.0;
+        return true;
+    }
+    bool ok = false;
+    *value = QByteArray(begin, int(end - begin)).toDouble(&ok);
+    return ok;
+}
+
+int digits(const char* p, int count) {
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// yyyy-MM-dd without building a QString; other layouts through QDate
+QDate parseDate(const char* begin, int size) {
+    const char* end = begin + size;
+    trim(begin, end);
+    const char* p = begin;
+    if (end - p == 10 && p[4] == '-' && p[7] == '-' && isDigit(p[0]) && isDigit(p[1])
+        && isDigit(p[2]) && isDigit(p[3]) && isDigit(p[5]) && isDigit(p[6]) && isDigit(p[8])
+        && isDigit(p[9])) {
+        return QDate(digits(p, 4), digits(p + 5, 2), digits(p + 8, 2));
+    }
+
+    QString text = QString::fromUtf8(p, int(end - p));
+    QDate date = QDate::fromString(text, Qt::ISODate);
+    for (const char* format : {"yyyy/MM/dd", "M/d/yyyy", "d.M.yyyy"}) {
+        if (date.isValid()) {
+            break;
+        }
+        date = QDate::fromString(text, QLatin1String(format));
+    }
+    return date;
+}
+
+// H:mm, HH:mm or HH:mm:ss
+QTime parseTime(const char* begin, int size) {
+    const char* end = begin + size;
+    trim(begin, end);
+    int length = int(end - begin);
+    int colon = length > 1 && begin[1] == ':' ? 1 : 2;
+    if ((length == colon + 3 || (length == colon + 6 && begin[colon + 3] == ':'))
+        && begin[colon] == ':') {
+        for (int i = 0; i < length; ++i) {
+            if (!isDigit(begin[i]) && begin[i] != ':') {
+                return QTime();
+            }
+        }
+        int seconds = length == colon + 6 ? digits(begin + colon + 4, 2) : 0;
+        return QTime(digits(begin, colon), digits(begin + colon + 1, 2), seconds);
+    }
+    return QTime::fromString(QString::fromUtf8(begin, length), Qt::ISODate);
+}
+
+QString headerKey(const QString& name) {
+    return name.toLower().replace('_', ' ').simplified();
+}
+}
+
+CsvReader::CsvReader(QIODevice& device)
+    : m_device(device), m_pos(0), m_size(0), m_atStart(true) {
+    // Reserved, so clearing a row or refilling keeps the allocation
+    m_buffer.reserve(ChunkSize);
+    m_row.reserve(4096);
+}
+
+bool CsvReader::fill() {
+    m_buffer.resize(ChunkSize);
+    qint64 read = m_device.read(m_buffer.data(), ChunkSize);
+    m_size = read > 0 ? int(read) : 0;
+    m_pos = 0;
+
+    // Spreadsheets often start the file with a UTF-8 byte order mark
+    if (m_atStart && m_size >= 3 && qstrncmp(m_buffer.constData(), "\xEF\xBB\xBF", 3) == 0) {
+        m_pos = 3;
+    }
+    m_atStart = false;
+    return m_pos < m_size;
+}
+
+void CsvReader::endField() {
+    m_row.append('\0');
+    m_ends.append(m_row.size());
+}
+
+bool CsvReader::readRow() {
+    m_row.resize(0);
+    m_ends.resize(0);
+    bool started = false;
+    bool inQuotes = false;
+
+    for (;;) {
+        if (m_pos >= m_size && !fill()) {
+            // Last row without a line break
+            if (!started) {
+                return false;
+            }
+            endField();
+            return true;
+        }
+        const char* data = m_buffer.constData();
+
+        if (inQuotes) {
+            // Everything up to the next quote is field content
+            const char* quote =
+                static_cast<const char*>(std::memchr(data + m_pos, '"', size_t(m_size - m_pos)));
+            int stop = quote ? int(quote - data) : m_size;
+            m_row.append(data + m_pos, stop - m_pos);
+            m_pos = stop;
+            if (!quote) {
+                continue;
+            }
+            ++m_pos;
+            // A doubled quote is a literal one; it may start the next chunk
+            if ((m_pos < m_size || fill()) && m_buffer.at(m_pos) == '"') {
+                m_row.append('"');
+                ++m_pos;
+            } else {
+                inQuotes = false;
+            }
+            continue;
+        }
+
+        int stop = m_pos;
+        while (stop < m_size) {
+            char c = data[stop];
+            if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+                break;
+            }
+            ++stop;
+        }
+        if (stop > m_pos) {
+            m_row.append(data + m_pos, stop - m_pos);
+            started = true;
+        }
+        m_pos = stop;
+        if (stop == m_size) {
+            continue;
+        }
+
+        char c = data[m_pos++];
+        if (c == '"') {
+            inQuotes = true;
+            started = true;
+        } else if (c == ',') {
+            endField();
+            started = true;
+        } else {
+            if (c == '\r' && (m_pos < m_size || fill()) && m_buffer.at(m_pos) == '\n') {
+                ++m_pos;
+            }
+            // Blank lines are skipped
+            if (started) {
+                endField();
+                return true;
+            }
+        }
+    }
+}
+
+QString CsvReader::text(int i) const {
+    return QString::fromUtf8(field(i), fieldSize(i)).trimmed();
+}
+
+CsvImporter::CsvImporter(const QList<Symptom>& symptoms)
+    : m_symptoms(symptoms), m_rows(0) {
+}
+
+bool CsvImporter::read(QIODevice& device) {
+    m_columns.clear();
+    m_newSymptoms.clear();
+    m_observed.clear();
+    m_entries.clear();
+    m_rows = 0;
+    m_error.clear();
+    m_timestamp = QDateTime::currentDateTime();
+
+    CsvReader reader(device);
+    if (!readHeader(reader)) {
+        return false;
+    }
+    while (reader.readRow()) {
+        readRow(reader);
+    }
+
+    // Columns that only held 0 and 1 become checkboxes, whole numbers counts
+    for (int i = 0; i < m_newSymptoms.size(); ++i) {
+        m_newSymptoms[i].setType(m_observed[i].binary     ? SymptomType::Binary
+                                 : m_observed[i].integral ? SymptomType::Count
+                                                          : SymptomType::Quantity);
+    }
+    return true;
+}
+
+bool CsvImporter::readHeader(CsvReader& reader) {
+    if (!reader.readRow()) {
+        m_error = "The file is empty.";
+        return false;
+    }
+
+    QHash<QString, QString> known;
+    for (const Symptom& symptom : m_symptoms) {
+        known.insert(headerKey(symptom.getName()), symptom.getName());
+    }
+    const QHash<QString, ColumnKind> fixed = {
+        {"date", ColumnKind::Date},
+        {"id", ColumnKind::Id},
+        {"sleep duration", ColumnKind::Duration},
+        {"duration", ColumnKind::Duration},
+        {"hours", ColumnKind::Duration},
+        {"bedtime", ColumnKind::Bedtime},
+        {"bed time", ColumnKind::Bedtime},
+        {"wake time", ColumnKind::WakeTime},
+        {"waketime", ColumnKind::WakeTime},
+        {"wakeup", ColumnKind::WakeTime},
+        {"wake up", ColumnKind::WakeTime},
+        {"notes", ColumnKind::Notes},
+        {"note", ColumnKind::Notes},
+        {"timestamp", ColumnKind::Ignored},
+    };
+
+    bool hasDate = false;
+    QHash<QString, int> created;
+    m_columns.resize(reader.fieldCount());
+    for (int i = 0; i < reader.fieldCount(); ++i) {
+        QString name = reader.text(i);
+        QString key = headerKey(name);
+        Column& column = m_columns[i];
+        if (key.isEmpty()) {
+            continue;
+        }
+
+        auto kind = fixed.constFind(key);
+        if (kind != fixed.constEnd()) {
+            column.kind = kind.value();
+            hasDate = hasDate || column.kind == ColumnKind::Date;
+            continue;
+        }
+
+        column.kind = ColumnKind::Symptom;
+        auto symptom = known.constFind(key);
+        if (symptom != known.constEnd()) {
+            column.symptom = symptom.value();
+        } else if (created.contains(key)) {
+            column.symptom = m_newSymptoms[created.value(key)].getName();
+            column.created = created.value(key);
+        } else {
+            column.symptom = name;
+            column.created = m_newSymptoms.size();
+            created.insert(key, column.created);
+            m_newSymptoms.append(Symptom(name, SymptomType::Quantity));
+            m_observed.append(Observed());
+        }
+    }
+
+    if (!hasDate) {
+        m_error = "The header row has no Date column.";
+        return false;
+    }
+    return true;
+}
+
+void CsvImporter::readRow(const CsvReader& reader) {
+    ++m_rows;
+    SleepEntry entry{QUuid()};
+    entry.timestamp = m_timestamp;
+    bool hasDuration = false;
+
+    int count = qMin(reader.fieldCount(), m_columns.size());
+    for (int i = 0; i < count; ++i) {
+        const Column& column = m_columns[i];
+        const char* field = reader.field(i);
+        int size = reader.fieldSize(i);
+        double value;
+
+        switch (column.kind) {
+        case ColumnKind::Ignored:
+            break;
+        case ColumnKind::Date:
+            entry.date = parseDate(field, size);
+            break;
+        case ColumnKind::Id:
+            entry.id = QUuid::fromString(QLatin1String(field, size).trimmed());
+            break;
+        case ColumnKind::Duration:
+            hasDuration = parseNumber(field, size, &entry.hours);
+            break;
+        case ColumnKind::Bedtime:
+            entry.bedtime = parseTime(field, size);
+            break;
+        case ColumnKind::WakeTime:
+            entry.waketime = parseTime(field, size);
+            break;
+        case ColumnKind::Notes:
+            entry.notes = reader.text(i);
+            break;
+        case ColumnKind::Symptom:
+            // An empty cell is a symptom that was not recorded that night
+            if (parseNumber(field, size, &value)) {
+                entry.symptomData.append(qMakePair(column.symptom, value));
+                if (column.created >= 0) {
+                    Observed& observed = m_observed[column.created];
+                    observed.binary = observed.binary && (value == 0.0 || value == 1.0);
+                    observed.integral = observed.integral && std::floor(value) == value;
+                }
+            }
+            break;
+        }
+    }
+
+    if (!entry.date.isValid()) {
+        return;
+    }
+    if (entry.id.isNull()) {
+        entry.id = QUuid::createUuidV5(
+            ImportNamespace, entry.date.toString(Qt::ISODate).toLatin1() + '\0' + reader.rowData());
+    }
+
+    // Same rule as the entry form: a wake time before the bedtime is the
+    // next morning
+    if (!hasDuration && entry.bedtime.isValid() && entry.waketime.isValid()) {
+        QDateTime bed(entry.date, entry.bedtime);
+        QDateTime wake(entry.date.addDays(entry.waketime > entry.bedtime ? 0 : 1),
+                       entry.waketime);
+        entry.hours = bed.secsTo(wake) / 3600.0;
+    }
+    m_entries.append(entry);
+}
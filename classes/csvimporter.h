@@ -0,0 +1,97 @@
+//created by drmrsthemonarch with ai effort
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "sleepentry.h"
+#include "symptom.h"
+
+// Quote-aware CSV tokenizer (RFC 4180) over UTF-8 input, read from the
+// device in large chunks. Quoted fields may hold commas, doubled quotes
+// and line breaks. Runs between delimiters are copied with one append
+// each, and the fields of a row share one buffer, each followed by a NUL.
+class CsvReader {
+public:
+    explicit CsvReader(QIODevice& device);
+
+    // Next non-blank row; false at the end of the input. The fields stay
+    // valid until the next call.
+    bool readRow();
+
+    int fieldCount() const { return m_ends.size(); }
+    const char* field(int i) const { return m_row.constData() + start(i); }
+    int fieldSize(int i) const { return m_ends[i] - 1 - start(i); }
+    QString text(int i) const;
+    // Every field of the row as read, each followed by a NUL
+    const QByteArray& rowData() const { return m_row; }
+
+private:
+    int start(int i) const { return i == 0 ? 0 : m_ends[i - 1]; }
+    bool fill();
+    void endField();
+
+    QIODevice& m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    int m_size;
+    bool m_atStart;
+    QByteArray m_row;
+    QVector<int> m_ends;
+};
+
+// Reads sleep history from another tracker or a spreadsheet. The header
+// row picks the columns: Date is required; Id, Sleep duration, Bedtime,
+// Wake time and Notes are optional; every other column is a symptom,
+// matched to the existing definitions by name. A column with no
+// definition becomes a new symptom typed from its values. The export
+// format reads back as is.
+class CsvImporter {
+public:
+    explicit CsvImporter(const QList<Symptom>& symptoms);
+
+    // False if the input has no header or no date column; see error()
+    bool read(QIODevice& device);
+
+    QString error() const { return m_error; }
+    // One per row with a valid date, in file order
+    const QVector<SleepEntry>& entries() const { return m_entries; }
+    const QList<Symptom>& newSymptoms() const { return m_newSymptoms; }
+    int rows() const { return m_rows; }
+    // Rows left out for having no readable date
+    int skipped() const { return m_rows - m_entries.size(); }
+
+private:
+    enum class ColumnKind { Ignored, Date, Id, Duration, Bedtime, WakeTime, Notes, Symptom };
+
+    struct Column {
+        ColumnKind kind = ColumnKind::Ignored;
+        QString symptom;
+        // Index into m_newSymptoms, or -1 for a known symptom
+        int created = -1;
+    };
+
+    // What the values of a new symptom column looked like so far
+    struct Observed {
+        bool binary = true;
+        bool integral = true;
+    };
+
+    bool readHeader(CsvReader& reader);
+    void readRow(const CsvReader& reader);
+
+    QList<Symptom> m_symptoms;
+    QVector<Column> m_columns;
+    QList<Symptom> m_newSymptoms;
+    QVector<Observed> m_observed;
+    QVector<SleepEntry> m_entries;
+    QDateTime m_timestamp;
+    int m_rows;
+    QString m_error;
+};
+
+#endif // CSVIMPORTER_H
@@ -1,80 +1,149 @@
 //created by drmrsthemonarch with ai effort
 #include "dataencryption.h"
-#include <QCryptographicHash>
-#include <QFile>
-#include <QDataStream>
-
-QByteArray DataEncryption::deriveKey(const QString& password) {
-    // Use SHA256 to create a 32-byte key from password
-    QByteArray key = QCryptographicHash::hash(
-        password.toUtf8(),
-        QCryptographicHash::Sha256
-    );
-    return key;
+#include "chacha20poly1305.h"
+#include "encrypteddevice.h"
+#include <QRandomGenerator>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SLEEPBOOK_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+QByteArray DataEncryption::encrypt(const QByteArray& data, const SessionKey& key,
+                                   const QByteArray& associated) {
+    const QByteArray& cipherKey = key.cipherKey();
+    if (cipherKey.size() != ChaCha20Poly1305::KeySize) {
+        return QByteArray();
+    }
+
+    QByteArray sealed(RecordOverhead + data.size(), Qt::Uninitialized);
+    char* nonce = sealed.data();
+    char* body = nonce + ChaCha20Poly1305::NonceSize;
+    quint32 random[ChaCha20Poly1305::NonceSize / 4];
+    QRandomGenerator::system()->fillRange(random);
+    std::memcpy(nonce, random, sizeof(random));
+    std::memcpy(body, data.constData(), size_t(data.size()));
+
+    ChaCha20Poly1305::seal(reinterpret_cast<const uchar*>(cipherKey.constData()),
+                           reinterpret_cast<const uchar*>(nonce),
+                           reinterpret_cast<const uchar*>(associated.constData()),
+                           associated.size(), body, data.size(),
+                           reinterpret_cast<uchar*>(body + data.size()));
+    return sealed;
 }
 
-QByteArray DataEncryption::encrypt(const QByteArray& data, const QString& password) {
-    QByteArray key = deriveKey(password);
-    QByteArray encrypted;
-    encrypted.resize(data.size());
-    
-    // XOR encryption with repeating key
-    for (int i = 0; i < data.size(); ++i) {
-        encrypted[i] = data[i] ^ key[i % key.size()];
+bool DataEncryption::decryptInPlace(QByteArray& data, const SessionKey& key,
+                                    const QByteArray& associated) {
+    const QByteArray& cipherKey = key.cipherKey();
+    if (data.size() < RecordOverhead || cipherKey.size() != ChaCha20Poly1305::KeySize) {
+        data.clear();
+        return false;
     }
-    
-    return encrypted;
+
+    int size = data.size() - RecordOverhead;
+    char* nonce = data.data();
+    char* body = nonce + ChaCha20Poly1305::NonceSize;
+    if (!ChaCha20Poly1305::open(reinterpret_cast<const uchar*>(cipherKey.constData()),
+                                reinterpret_cast<const uchar*>(nonce),
+                                reinterpret_cast<const uchar*>(associated.constData()),
+                                associated.size(), body, size,
+                                reinterpret_cast<const uchar*>(body + size))) {
+        data.clear();
+        return false;
+    }
+
+    // Slide the plaintext over the nonce; no second buffer
+    std::memmove(data.data(), body, size_t(size));
+    data.resize(size);
+    return true;
 }
 
-QByteArray DataEncryption::decrypt(const QByteArray& data, const QString& password) {
-    // XOR is symmetric, so decrypt is the same as encrypt
-    return encrypt(data, password);
+void DataEncryption::decryptLegacyInPlace(QByteArray& data, const SessionKey& key) {
+    if (data.isEmpty()) {
+        return;
+    }
+    applyKeystream(data.data(), data.size(), key.legacyKey());
 }
 
-bool DataEncryption::saveEncrypted(const QString& filename, const QByteArray& data, const QString& password) {
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly)) {
+void DataEncryption::applyKeystream(char* data, qint64 size, const QByteArray& key,
+                                    qint64 position) {
+    const int keySize = key.size();
+    if (size <= 0 || keySize == 0) {
+        return;
+    }
+    const uchar* k = reinterpret_cast<const uchar*>(key.constData());
+    uchar* p = reinterpret_cast<uchar*>(data);
+    int keyIndex = int(position % keySize);
+
+    // The wide paths need a key that tiles a 32-byte block (SHA-256 keys do)
+    if (32 % keySize != 0) {
+        for (qint64 i = 0; i < size; ++i) {
+            p[i] ^= k[keyIndex];
+            if (++keyIndex == keySize) {
+                keyIndex = 0;
+            }
+        }
+        return;
+    }
+
+    // Two copies of the key block, so any start offset reads 32 straight bytes
+    uchar block[64];
+    for (int i = 0; i < 64; ++i) {
+        block[i] = k[i % keySize];
+    }
+    const uchar* stream = block + (keyIndex % 32);
+
+    qint64 i = 0;
+#ifdef SLEEPBOOK_HAVE_SSE2
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream + 16));
+    for (; i + 32 <= size; i += 32) {
+        __m128i* out = reinterpret_cast<__m128i*>(p + i);
+        _mm_storeu_si128(out, _mm_xor_si128(_mm_loadu_si128(out), low));
+        _mm_storeu_si128(out + 1, _mm_xor_si128(_mm_loadu_si128(out + 1), high));
+    }
+#else
+    quint64 words[4];
+    std::memcpy(words, stream, sizeof(words));
+    for (; i + 32 <= size; i += 32) {
+        for (int w = 0; w < 4; ++w) {
+            quint64 value;
+            std::memcpy(&value, p + i + w * 8, 8);
+            value ^= words[w];
+            std::memcpy(p + i + w * 8, &value, 8);
+        }
+    }
+#endif
+
+    // Tail shorter than one key block
+    for (int j = 0; i < size; ++i, ++j) {
+        p[i] ^= stream[j];
+    }
+}
+
+bool DataEncryption::saveEncrypted(const QString& filename, const QByteArray& data, const SessionKey& key) {
+    // Encrypted a chunk at a time on the way out; no second copy of the data
+    EncryptedDevice device(filename, key);
+    if (!device.open(QIODevice::WriteOnly)) {
         return false;
     }
-    
-    QByteArray encrypted = encrypt(data, password);
-    
-    QDataStream out(&file);
-    out.setVersion(QDataStream::Qt_5_15);
-    
-    // Write magic number to identify our format
-    out << quint32(0x534C5050); // "SLPP" (Sleep Tracker)
-    // Write version
-    out << quint32(1);
-    // Write encrypted data
-    out << encrypted;
-    
-    file.close();
-    return true;
+
+    bool ok = device.write(data) == data.size();
+    device.close();
+    return ok && device.isOk();
 }
 
-QByteArray DataEncryption::loadEncrypted(const QString& filename, const QString& password) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+QByteArray DataEncryption::loadEncrypted(const QString& filename, const SessionKey& key) {
+    EncryptedDevice device(filename, key);
+    if (!device.open(QIODevice::ReadOnly)) {
         return QByteArray();
     }
-    
-    QDataStream in(&file);
-    in.setVersion(QDataStream::Qt_5_15);
-    
-    quint32 magic, version;
-    in >> magic >> version;
-    
-    // Verify magic number
-    if (magic != 0x534C5050) {
-        file.close();
+
+    // Read straight into the result and decrypted in place there
+    QByteArray data(int(device.payloadSize()), Qt::Uninitialized);
+    if (device.read(data.data(), data.size()) != data.size() || !device.isOk()) {
         return QByteArray();
     }
-    
-    QByteArray encrypted;
-    in >> encrypted;
-    
-    file.close();
-    
-    return decrypt(encrypted, password);
-}
\ No newline at end of file
+    return data;
+}
@@ -4,19 +4,33 @@
 
 #include <QByteArray>
 #include <QString>
+#include "sessionkey.h"
 
 class DataEncryption {
 public:
-    // Encrypt/Decrypt using XOR with derived key
-    static QByteArray encrypt(const QByteArray& data, const QString& password);
-    static QByteArray decrypt(const QByteArray& data, const QString& password);
-    
-    // Generate encryption key from password
-    static QByteArray deriveKey(const QString& password);
+    // Records are sealed with ChaCha20-Poly1305 under the session's cipher
+    // key: a random 12-byte nonce, the ciphertext and a 16-byte tag.
+    // associated is authenticated but not stored, e.g. the record's id.
+    static QByteArray encrypt(const QByteArray& data, const SessionKey& key,
+                              const QByteArray& associated = QByteArray());
+    // Opens a sealed record in place; false, with data cleared, if it was
+    // altered, belongs elsewhere or the key is wrong
+    static bool decryptInPlace(QByteArray& data, const SessionKey& key,
+                               const QByteArray& associated = QByteArray());
+    static const int RecordOverhead = 28;
+
+    // Records of the version 1 formats: XOR with the legacy key
+    static void decryptLegacyInPlace(QByteArray& data, const SessionKey& key);
+
+    // XORs size bytes at data with key repeated from keystream offset
+    // position; 16 bytes per step with SSE2, 8 with plain 64-bit words
+    static void applyKeystream(char* data, qint64 size, const QByteArray& key,
+                               qint64 position = 0);
     
-    // Save/Load encrypted data to/from file
-    static bool saveEncrypted(const QString& filename, const QByteArray& data, const QString& password);
-    static QByteArray loadEncrypted(const QString& filename, const QString& password);
+    // Save/Load encrypted data to/from file; writes SLPP version 2 and
+    // reads versions 1 and 2 (see EncryptedDevice)
+    static bool saveEncrypted(const QString& filename, const QByteArray& data, const SessionKey& key);
+    static QByteArray loadEncrypted(const QString& filename, const SessionKey& key);
 };
 
 #endif // DATAENCRYPTION_H
\ No newline at end of file
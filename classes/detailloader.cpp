@@ -0,0 +1,75 @@
+//created by drmrsthemonarch with ai effort
+#include "detailloader.h"
+#include <QFile>
+#include <QMetaObject>
+#include <QtConcurrent>
+
+DetailLoader::DetailLoader(QObject* parent)
+    : QObject(parent), m_generation(0), m_running(false) {
+}
+
+DetailLoader::~DetailLoader() {
+    // Workers only touch this object through queued calls, but none may
+    // outlive the generation counter it polls, including abandoned ones
+    // still finishing their current batch
+    m_generation.fetchAndAddOrdered(1);
+    m_workers.waitForFinished();
+}
+
+QFuture<void> DetailLoader::load(const DetailStore::ReadPlan& plan) {
+    // Abandon any load in flight; it is being replaced, not cancelled
+    quint64 generation = m_generation.fetchAndAddOrdered(1) + 1;
+    m_running = true;
+
+    // Keep only the workers still running, so the list does not grow with
+    // every load over a long session
+    const QList<QFuture<void>> workers = m_workers.futures();
+    m_workers.clearFutures();
+    for (const QFuture<void>& worker : workers) {
+        if (!worker.isFinished()) {
+            m_workers.addFuture(worker);
+        }
+    }
+
+    QFuture<void> future =
+        QtConcurrent::run([this, plan, generation]() { run(plan, generation); });
+    m_workers.addFuture(future);
+    return future;
+}
+
+void DetailLoader::cancel() {
+    m_generation.fetchAndAddOrdered(1);
+    if (m_running) {
+        m_running = false;
+        emit cancelled();
+    }
+}
+
+void DetailLoader::run(const DetailStore::ReadPlan& plan, quint64 generation) {
+    QFile pack(plan.packFile);
+    bool ok = pack.open(QIODevice::ReadOnly);
+    int total = plan.records.size();
+
+    for (int first = 0; ok && first < total; first += BatchSize) {
+        if (m_generation.loadAcquire() != generation) {
+            return;
+        }
+
+        QVector<SleepEntry> batch =
+            DetailStore::readEntries(pack, plan, first, qMin(first + BatchSize, total));
+
+        // Delivered on the GUI thread; dropped there if the load was abandoned
+        QMetaObject::invokeMethod(this, [this, batch, generation]() {
+            if (m_generation.loadAcquire() == generation) {
+                emit entriesLoaded(batch);
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    QMetaObject::invokeMethod(this, [this, generation]() {
+        if (m_generation.loadAcquire() == generation) {
+            m_running = false;
+            emit finished();
+        }
+    }, Qt::QueuedConnection);
+}
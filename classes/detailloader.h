@@ -0,0 +1,46 @@
+//created by drmrsthemonarch with ai effort
+#ifndef DETAILLOADER_H
+#define DETAILLOADER_H
+
+#include <QAtomicInteger>
+#include <QFuture>
+#include <QFutureSynchronizer>
+#include <QObject>
+#include <QVector>
+#include "detailstore.h"
+
+// Reads, decrypts and parses detail records on the global thread pool.
+// Results come back in batches through queued signals so a tab can fill in
+// progressively; each batch is decoded across all cores and sorted by night.
+// Starting a new load or calling cancel() abandons the one in flight: its
+// worker stops at the next batch and nothing more is delivered.
+class DetailLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DetailLoader(QObject* parent = nullptr);
+    ~DetailLoader();
+
+    QFuture<void> load(const DetailStore::ReadPlan& plan);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    // Records per delivered batch, large enough to keep every core busy
+    static const int BatchSize = 256;
+
+signals:
+    void entriesLoaded(const QVector<SleepEntry>& entries);
+    void finished();
+    void cancelled();
+
+private:
+    void run(const DetailStore::ReadPlan& plan, quint64 generation);
+
+    QAtomicInteger<quint64> m_generation;
+    // Every worker not yet finished, abandoned ones included; each polls
+    // the generation and posts to this object until it returns
+    QFutureSynchronizer<void> m_workers;
+    bool m_running;
+};
+
+#endif // DETAILLOADER_H
@@ -0,0 +1,599 @@
+//created by drmrsthemonarch with ai effort
+#include "detailstore.h"
+#include "dataencryption.h"
+#include "storagesync.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const quint32 PackMagic = 0x534C504B;  // "SLPK" (Sleep Pack)
+const quint32 IndexMagic = 0x534C5049; // "SLPI" (Sleep Index)
+const quint32 LegacyPackVersion = 1; // records XORed with the legacy key
+const quint32 PackVersion = 2;       // records sealed, bound to their UUID
+const qint64 PackHeaderSize = 8;
+const qint64 RecordHeaderSize = 20; // 16-byte UUID + quint32 length
+
+// Neighbouring records closer than this are fetched with a single read
+const qint64 MaxReadGap = 64 * 1024;
+const qint64 MaxReadSpan = 4 * 1024 * 1024;
+
+// Below this many records a batch is decrypted on the calling thread
+const int ParallelThreshold = 16;
+
+// Records sealed and appended together by writeMany
+const int WriteSliceRecords = 4096;
+
+// Compact once superseded records outweigh live ones and this is worth it
+const qint64 CompactionMinBytes = 256 * 1024;
+
+// The index is rewritten once this much has been appended past it, which
+// bounds the scan needed to recover after a crash
+const qint64 IndexRefreshBytes = 1024 * 1024;
+
+QByteArray recordHeader(const QUuid& id, quint32 length) {
+    QByteArray header = id.toRfc4122();
+    header.resize(int(RecordHeaderSize));
+    qToBigEndian(length, header.data() + 16);
+    return header;
+}
+
+bool openRecord(QByteArray& record, const QUuid& id, const SessionKey& key) {
+    return DataEncryption::decryptInPlace(record, key, id.toRfc4122());
+}
+}
+
+DetailStore::DetailStore()
+    : m_deadBytes(0), m_indexedSize(0), m_indexDirty(false) {
+}
+
+DetailStore::~DetailStore() {
+    close();
+}
+
+QString DetailStore::packFileFor(const QString& directory) {
+    return directory + "/sleep_details.pack";
+}
+
+QString DetailStore::indexFileFor(const QString& directory) {
+    return directory + "/sleep_details.idx";
+}
+
+bool DetailStore::open(const QString& directory, const SessionKey& key) {
+    close();
+
+    m_directory = directory;
+    m_key = key;
+
+    // Compactions before packs were replaced in one rename could be cut
+    // off with the pack only under its .old name
+    QString packPath = packFileFor(directory);
+    if (!QFile::exists(packPath) && QFile::exists(packPath + ".old")) {
+        QFile::rename(packPath + ".old", packPath);
+    }
+    QFile::remove(packPath + ".tmp");
+
+    m_file.setFileName(packPath);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    bool legacyPack = false;
+    if (m_file.size() == 0) {
+        stream << PackMagic << PackVersion;
+        m_file.flush();
+    } else {
+        quint32 magic, version;
+        stream >> magic >> version;
+        if (magic != PackMagic || (version != PackVersion && version != LegacyPackVersion)) {
+            m_file.close();
+            return false;
+        }
+        legacyPack = version == LegacyPackVersion;
+    }
+
+    // The index is only a cache of the pack; rebuild it when it is missing
+    if (!loadIndex()) {
+        m_index.clear();
+        m_deadBytes = 0;
+        scanFrom(PackHeaderSize);
+    }
+
+    // An older pack is resealed in one pass before anything is appended
+    if (legacyPack && !compact(true)) {
+        close();
+        return false;
+    }
+
+    qint64 liveBytes = m_file.size() - PackHeaderSize - m_deadBytes;
+    if (m_deadBytes > CompactionMinBytes && m_deadBytes > liveBytes) {
+        compact(false);
+    }
+
+    if (m_indexDirty) {
+        saveIndex();
+    }
+    return true;
+}
+
+void DetailStore::close() {
+    if (m_file.isOpen()) {
+        if (m_indexDirty) {
+            saveIndex();
+        }
+        m_file.close();
+    }
+    m_directory.clear();
+    m_key.clear();
+    m_index.clear();
+    m_deadBytes = 0;
+    m_indexedSize = 0;
+    m_indexDirty = false;
+}
+
+QByteArray DetailStore::read(const QUuid& id) {
+    auto it = m_index.constFind(id);
+    if (it == m_index.constEnd() || !m_file.seek(it->offset)) {
+        return QByteArray();
+    }
+
+    QByteArray record = m_file.read(it->length);
+    if (record.size() != int(it->length) || !openRecord(record, id, m_key)) {
+        return QByteArray();
+    }
+    return record;
+}
+
+QHash<QUuid, QByteArray> DetailStore::readMany(const QVector<QUuid>& ids) {
+    ReadPlan plan = planRead(ids);
+    return readPlanned(m_file, plan, 0, plan.records.size());
+}
+
+DetailStore::ReadPlan DetailStore::planRead(const QVector<QUuid>& ids) const {
+    ReadPlan plan;
+    plan.packFile = m_file.fileName();
+    plan.key = m_key;
+    plan.records.reserve(ids.size());
+    for (const QUuid& id : ids) {
+        auto it = m_index.constFind(id);
+        if (it != m_index.constEnd()) {
+            plan.records.append(qMakePair(it.value(), id));
+        }
+    }
+    std::sort(plan.records.begin(), plan.records.end(),
+              [](const QPair<Location, QUuid>& a, const QPair<Location, QUuid>& b) {
+                  return a.first.offset < b.first.offset;
+              });
+    return plan;
+}
+
+QVector<QPair<QUuid, QByteArray>> DetailStore::readEncrypted(QFile& pack, const ReadPlan& plan,
+                                                              int first, int last) {
+    QVector<QPair<QUuid, QByteArray>> records;
+    records.reserve(last - first);
+    const auto& wanted = plan.records;
+
+    while (first < last) {
+        // Grow the span while the next record is close enough to share the read
+        qint64 spanStart = wanted[first].first.offset;
+        qint64 spanEnd = spanStart + wanted[first].first.length;
+        int spanLast = first + 1;
+        while (spanLast < last) {
+            const Location& next = wanted[spanLast].first;
+            qint64 nextEnd = next.offset + next.length;
+            if (next.offset - spanEnd > MaxReadGap || nextEnd - spanStart > MaxReadSpan) {
+                break;
+            }
+            spanEnd = qMax(spanEnd, nextEnd);
+            ++spanLast;
+        }
+
+        QByteArray span;
+        if (pack.seek(spanStart)) {
+            span = pack.read(spanEnd - spanStart);
+        }
+        if (span.size() == spanEnd - spanStart) {
+            for (int i = first; i < spanLast; ++i) {
+                const Location& location = wanted[i].first;
+                records.append(qMakePair(wanted[i].second,
+                                         span.mid(int(location.offset - spanStart),
+                                                  int(location.length))));
+            }
+        }
+        first = spanLast;
+    }
+
+    return records;
+}
+
+QHash<QUuid, QByteArray> DetailStore::readPlanned(QFile& pack, const ReadPlan& plan,
+                                                  int first, int last) {
+    QVector<QPair<QUuid, QByteArray>> encrypted = readEncrypted(pack, plan, first, last);
+
+    // Records are independent, so decryption fans out across the pool once
+    // a batch is big enough to pay for the hand-off
+    auto decrypt = [&plan](QPair<QUuid, QByteArray>& record) {
+        openRecord(record.second, record.first, plan.key);
+    };
+    if (encrypted.size() >= ParallelThreshold) {
+        QtConcurrent::blockingMap(encrypted, decrypt);
+    } else {
+        std::for_each(encrypted.begin(), encrypted.end(), decrypt);
+    }
+
+    QHash<QUuid, QByteArray> records;
+    records.reserve(encrypted.size());
+    for (const auto& record : qAsConst(encrypted)) {
+        // Records that failed authentication come back empty and are dropped
+        if (!record.second.isEmpty()) {
+            records.insert(record.first, record.second);
+        }
+    }
+    return records;
+}
+
+QVector<SleepEntry> DetailStore::readEntries(QFile& pack, const ReadPlan& plan,
+                                            int first, int last) {
+    QVector<QPair<QUuid, QByteArray>> encrypted = readEncrypted(pack, plan, first, last);
+
+    // Decrypt and parse each record on its own core, straight into its slot
+    QVector<SleepEntry> entries(encrypted.size(), SleepEntry(QUuid()));
+    SleepEntry* out = entries.data();
+    QPair<QUuid, QByteArray>* in = encrypted.data();
+    auto decode = [in, out, &plan](int& i) {
+        // A record that fails authentication keeps a null id and is dropped
+        if (openRecord(in[i].second, in[i].first, plan.key)) {
+            out[i] = SleepEntry::fromDetailRecord(in[i].second);
+            out[i].id = in[i].first;
+        }
+    };
+
+    QVector<int> indexes(encrypted.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    if (indexes.size() >= ParallelThreshold) {
+        QtConcurrent::blockingMap(indexes, decode);
+    } else {
+        std::for_each(indexes.begin(), indexes.end(), decode);
+    }
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const SleepEntry& entry) { return entry.id.isNull(); }),
+                  entries.end());
+
+    // The pack is in write order; hand the batch back in night order
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const SleepEntry& a, const SleepEntry& b) { return a.date < b.date; });
+    return entries;
+}
+
+bool DetailStore::write(const QUuid& id, const QByteArray& data) {
+    // A zero-length record marks a deletion, so empty payloads are not stored
+    if (!isOpen() || id.isNull() || data.isEmpty()) {
+        return false;
+    }
+    QByteArray sealed = DataEncryption::encrypt(data, m_key, id.toRfc4122());
+    return !sealed.isEmpty() && append(id, sealed);
+}
+
+bool DetailStore::writeMany(const QVector<QPair<QUuid, QByteArray>>& records) {
+    if (!isOpen()) {
+        return false;
+    }
+    for (const auto& record : records) {
+        if (record.first.isNull() || record.second.isEmpty()) {
+            return false;
+        }
+    }
+
+    qint64 start = m_file.size();
+    if (!m_file.seek(start)) {
+        return false;
+    }
+
+    // The index is only updated once everything is written
+    QVector<QPair<QUuid, Location>> located;
+    located.reserve(records.size());
+    QVector<QByteArray> sealed;
+    QByteArray slice;
+    qint64 position = start;
+    for (int first = 0; first < records.size(); first += WriteSliceRecords) {
+        int last = qMin(first + WriteSliceRecords, records.size());
+        sealed.resize(last - first);
+        QVector<int> indexes(last - first);
+        std::iota(indexes.begin(), indexes.end(), first);
+        QByteArray* out = sealed.data();
+        auto seal = [this, &records, out, first](int& i) {
+            out[i - first] = DataEncryption::encrypt(records[i].second, m_key,
+                                                     records[i].first.toRfc4122());
+        };
+        if (indexes.size() >= ParallelThreshold) {
+            QtConcurrent::blockingMap(indexes, seal);
+        } else {
+            std::for_each(indexes.begin(), indexes.end(), seal);
+        }
+
+        slice.clear();
+        for (int i = first; i < last; ++i) {
+            const QByteArray& encrypted = sealed[i - first];
+            if (encrypted.isEmpty()) {
+                m_file.resize(start);
+                return false;
+            }
+            slice += recordHeader(records[i].first, quint32(encrypted.size()));
+            slice += encrypted;
+            located.append(qMakePair(records[i].first,
+                                     Location{position + RecordHeaderSize,
+                                              quint32(encrypted.size())}));
+            position += RecordHeaderSize + encrypted.size();
+        }
+        if (m_file.write(slice) != slice.size()) {
+            m_file.resize(start);
+            return false;
+        }
+    }
+
+    // Synced now, or with the rest of the import when a StorageBatch is open
+    if (!StorageSync::appended(m_file)) {
+        m_file.resize(start);
+        return false;
+    }
+
+    for (const auto& record : qAsConst(located)) {
+        auto existing = m_index.constFind(record.first);
+        if (existing != m_index.constEnd()) {
+            m_deadBytes += RecordHeaderSize + existing->length;
+        }
+        m_index.insert(record.first, record.second);
+    }
+    m_indexDirty = true;
+
+    if (m_file.size() - m_indexedSize > IndexRefreshBytes) {
+        saveIndex();
+    }
+    return true;
+}
+
+bool DetailStore::remove(const QUuid& id) {
+    if (!isOpen()) {
+        return false;
+    }
+    if (!m_index.contains(id)) {
+        return true;
+    }
+    return append(id, QByteArray());
+}
+
+bool DetailStore::append(const QUuid& id, const QByteArray& encrypted) {
+    qint64 position = m_file.size();
+    if (!m_file.seek(position)) {
+        return false;
+    }
+
+    // Synced now, or with the rest of the save when a StorageBatch is open
+    QByteArray record = recordHeader(id, quint32(encrypted.size())) + encrypted;
+    if (m_file.write(record) != record.size() || !StorageSync::appended(m_file)) {
+        // Drop the partial record so the pack stays scannable
+        m_file.resize(position);
+        return false;
+    }
+
+    auto existing = m_index.constFind(id);
+    if (existing != m_index.constEnd()) {
+        m_deadBytes += RecordHeaderSize + existing->length;
+    }
+    if (encrypted.isEmpty()) {
+        m_index.remove(id);
+        m_deadBytes += RecordHeaderSize;
+    } else {
+        m_index.insert(id, Location{position + RecordHeaderSize, quint32(encrypted.size())});
+    }
+    m_indexDirty = true;
+
+    if (m_file.size() - m_indexedSize > IndexRefreshBytes) {
+        saveIndex();
+    }
+    return true;
+}
+
+int DetailStore::rebuildIndex() {
+    if (!isOpen()) {
+        return -1;
+    }
+
+    QHash<QUuid, Location> previous = m_index;
+    m_index.clear();
+    m_deadBytes = 0;
+    scanFrom(PackHeaderSize);
+    if (!saveIndex()) {
+        return -1;
+    }
+
+    int corrected = 0;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        auto old = previous.constFind(it.key());
+        if (old == previous.constEnd() || old->offset != it->offset || old->length != it->length) {
+            ++corrected;
+        }
+        previous.remove(it.key());
+    }
+    return corrected + previous.size();
+}
+
+bool DetailStore::loadIndex() {
+    QFile file(indexFileFor(m_directory));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic, version, count;
+    qint64 coveredSize, deadBytes;
+    in >> magic >> version >> coveredSize >> deadBytes >> count;
+    if (in.status() != QDataStream::Ok || magic != IndexMagic || version != PackVersion
+        || coveredSize < PackHeaderSize || coveredSize > m_file.size()) {
+        return false;
+    }
+
+    m_index.clear();
+    m_index.reserve(int(count));
+    char uuid[16];
+    for (quint32 i = 0; i < count; ++i) {
+        Location location;
+        if (in.readRawData(uuid, 16) != 16) {
+            return false;
+        }
+        in >> location.offset >> location.length;
+        m_index.insert(QUuid::fromRfc4122(QByteArray::fromRawData(uuid, 16)), location);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    m_deadBytes = deadBytes;
+    m_indexedSize = coveredSize;
+    file.close();
+
+    // Pick up records appended after the index was last written
+    if (coveredSize < m_file.size()) {
+        scanFrom(coveredSize);
+    }
+    return true;
+}
+
+bool DetailStore::scanFrom(qint64 position) {
+    qint64 end = m_file.size();
+
+    while (position + RecordHeaderSize <= end) {
+        if (!m_file.seek(position)) {
+            break;
+        }
+        QByteArray header = m_file.read(RecordHeaderSize);
+        if (header.size() != RecordHeaderSize) {
+            break;
+        }
+
+        QUuid id = QUuid::fromRfc4122(header.left(16));
+        quint32 length = qFromBigEndian<quint32>(header.constData() + 16);
+        // A torn tail from an interrupted append is cut off below
+        if (position + RecordHeaderSize + length > end) {
+            break;
+        }
+
+        auto existing = m_index.constFind(id);
+        if (existing != m_index.constEnd()) {
+            m_deadBytes += RecordHeaderSize + existing->length;
+        }
+        if (length == 0) {
+            m_index.remove(id);
+            m_deadBytes += RecordHeaderSize;
+        } else {
+            m_index.insert(id, Location{position + RecordHeaderSize, length});
+        }
+
+        position += RecordHeaderSize + length;
+    }
+
+    if (position < end) {
+        m_file.resize(position);
+    }
+    m_indexDirty = true;
+    return true;
+}
+
+bool DetailStore::saveIndex() {
+    QSaveFile file(indexFileFor(m_directory));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << IndexMagic << PackVersion << m_file.size() << m_deadBytes
+        << quint32(m_index.size());
+
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        QByteArray uuid = it.key().toRfc4122();
+        out.writeRawData(uuid.constData(), uuid.size());
+        out << it->offset << it->length;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        return false;
+    }
+    m_indexedSize = m_file.size();
+    m_indexDirty = false;
+    return true;
+}
+
+bool DetailStore::compact(bool reseal) {
+    // Written beside the pack and renamed over it once complete and synced,
+    // so a crash at any point leaves one whole pack behind; returning before
+    // commit() discards it
+    QSaveFile temp(m_file.fileName());
+    if (!temp.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&temp);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << PackMagic << PackVersion;
+
+    // Copy live records in file order. Payloads stay encrypted as they are,
+    // unless they come from an older pack and have to be resealed.
+    QVector<QPair<Location, QUuid>> live;
+    live.reserve(m_index.size());
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        live.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(live.begin(), live.end(),
+              [](const QPair<Location, QUuid>& a, const QPair<Location, QUuid>& b) {
+                  return a.first.offset < b.first.offset;
+              });
+
+    QHash<QUuid, Location> compacted;
+    compacted.reserve(live.size());
+    for (const auto& record : live) {
+        if (!m_file.seek(record.first.offset)) {
+            return false;
+        }
+        QByteArray encrypted = m_file.read(record.first.length);
+        if (encrypted.size() != int(record.first.length)) {
+            return false;
+        }
+        if (reseal) {
+            DataEncryption::decryptLegacyInPlace(encrypted, m_key);
+            encrypted = DataEncryption::encrypt(encrypted, m_key, record.second.toRfc4122());
+        }
+
+        qint64 position = temp.pos();
+        quint32 length = quint32(encrypted.size());
+        QByteArray bytes = recordHeader(record.second, length) + encrypted;
+        if (length == 0 || temp.write(bytes) != bytes.size()) {
+            return false;
+        }
+        compacted.insert(record.second, Location{position + RecordHeaderSize, length});
+    }
+
+    // The old index would point into the replaced pack; without one the
+    // next open rescans instead. Windows cannot replace an open file.
+    QFile::remove(indexFileFor(m_directory));
+    m_indexedSize = 0;
+    m_file.close();
+    bool committed = temp.commit();
+    if (!m_file.open(QIODevice::ReadWrite) || !committed) {
+        return false;
+    }
+    StorageSync::syncDirectory(m_directory);
+
+    m_index = compacted;
+    m_deadBytes = 0;
+    m_indexDirty = true;
+    return true;
+}
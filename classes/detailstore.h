@@ -0,0 +1,100 @@
+//created by drmrsthemonarch with ai effort
+#ifndef DETAILSTORE_H
+#define DETAILSTORE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+#include "sessionkey.h"
+#include "sleepentry.h"
+
+// Packed container for the per-night detail records.
+// All records live in one append-only file (sleep_details.pack), each
+// encrypted on its own and prefixed by its UUID and length. A side index
+// (sleep_details.idx) maps every UUID to its offset, so a single record is
+// one seek and a batch is a few large sequential reads. Rewrites and
+// deletes append; superseded bytes are reclaimed by compaction on open.
+// Records are sealed with ChaCha20-Poly1305 and bound to their UUID, so a
+// record moved under another id fails to open.
+class DetailStore {
+public:
+    struct Location {
+        qint64 offset; // start of the encrypted payload
+        quint32 length;
+    };
+
+    // Where a set of records lives, sorted by offset. The pack only grows
+    // while it is open, so a plan can be read from any thread with its own
+    // file handle until the store is closed.
+    struct ReadPlan {
+        QString packFile;
+        SessionKey key;
+        QVector<QPair<Location, QUuid>> records;
+    };
+
+    DetailStore();
+    ~DetailStore();
+
+    bool open(const QString& directory, const SessionKey& key);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    bool contains(const QUuid& id) const { return m_index.contains(id); }
+    int count() const { return m_index.size(); }
+    QVector<QUuid> ids() const { return m_index.keys().toVector(); }
+
+    // Throws the index away and scans the whole pack again, then rewrites
+    // the index file. Returns how many ids the old index had wrong, or -1.
+    int rebuildIndex();
+
+    // Decrypted record, or an empty array if the id is unknown
+    QByteArray read(const QUuid& id);
+    // Reads in file order, coalescing neighbouring records into one read
+    QHash<QUuid, QByteArray> readMany(const QVector<QUuid>& ids);
+
+    ReadPlan planRead(const QVector<QUuid>& ids) const;
+    // Reads plan.records[first, last) from an open pack; safe on any thread.
+    // Large batches are decrypted in parallel on the global thread pool.
+    static QHash<QUuid, QByteArray> readPlanned(QFile& pack, const ReadPlan& plan,
+                                                int first, int last);
+    // Same, but also parses each record; the result is sorted by night
+    static QVector<SleepEntry> readEntries(QFile& pack, const ReadPlan& plan,
+                                           int first, int last);
+
+    bool write(const QUuid& id, const QByteArray& data);
+    // Bulk write for imports: records are sealed across the thread pool and
+    // appended in large writes. All or nothing; on failure the pack is
+    // truncated back to where it was.
+    bool writeMany(const QVector<QPair<QUuid, QByteArray>>& records);
+    bool remove(const QUuid& id);
+
+    static QString packFileFor(const QString& directory);
+    static QString indexFileFor(const QString& directory);
+
+private:
+    static QVector<QPair<QUuid, QByteArray>> readEncrypted(QFile& pack, const ReadPlan& plan,
+                                                           int first, int last);
+
+    bool append(const QUuid& id, const QByteArray& encrypted);
+    bool loadIndex();
+    bool scanFrom(qint64 position);
+    bool saveIndex();
+    // Rewrites live records into a fresh pack; reseal converts an older
+    // pack's XOR records to sealed ones on the way
+    bool compact(bool reseal);
+
+    QString m_directory;
+    SessionKey m_key;
+    QFile m_file;
+    QHash<QUuid, Location> m_index;
+    qint64 m_deadBytes;
+    // Pack size covered by the index file on disk
+    qint64 m_indexedSize;
+    bool m_indexDirty;
+};
+
+#endif // DETAILSTORE_H
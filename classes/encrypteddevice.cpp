@@ -0,0 +1,429 @@
+//created by drmrsthemonarch with ai effort
+#include "encrypteddevice.h"
+#include "chacha20poly1305.h"
+#include "dataencryption.h"
+#include "storagesync.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace {
+const quint32 FileMagic = 0x534C5050; // "SLPP" (Sleep Tracker)
+const quint32 LegacyVersion = 1; // repeating-key XOR
+const quint32 NullLength = 0xFFFFFFFF; // QDataStream's null QByteArray
+
+// Version 2 header: magic, version, flags, segment size and salt, which
+// every segment authenticates, then the payload length patched on close
+const qint64 LengthOffset = 32;
+const int SaltSize = 16;
+const quint32 MaxSegmentSize = 16 * 1024 * 1024;
+
+// Header flag: every segment starts with a stored-length word, and the
+// segment is zlib-deflated when the word's top bit is set
+const quint32 CompressedSegments = 0x1;
+const quint32 KnownFlags = CompressedSegments;
+const quint32 DeflatedBit = 0x80000000;
+const int CompressionLevel = 6; // zlib's default; inflating costs the same at any level
+
+QByteArray headerPrefix(quint32 flags, quint32 segmentSize, const QByteArray& salt) {
+    QByteArray prefix;
+    QDataStream out(&prefix, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << FileMagic << FormatVersion << flags << segmentSize;
+    out.writeRawData(salt.constData(), salt.size());
+    return prefix;
+}
+
+const uchar* bytes(const QByteArray& array) {
+    return reinterpret_cast<const uchar*>(array.constData());
+}
+}
+
+EncryptedDevice::EncryptedDevice(const QString& fileName, const SessionKey& key,
+                                 QObject* parent)
+    : QIODevice(parent), m_file(fileName), m_output(fileName), m_sessionKey(key),
+      m_chunkOffset(0),
+      m_version(0), m_flags(0), m_segmentSize(SegmentSize), m_segmentIndex(0), m_position(0),
+      m_payloadSize(0), m_map(nullptr), m_mapSize(0), m_mapOffset(0), m_compress(true),
+      m_failed(false) {
+}
+
+EncryptedDevice::~EncryptedDevice() {
+    close();
+}
+
+bool EncryptedDevice::open(OpenMode mode) {
+    OpenMode access = mode & ReadWrite;
+    if (isOpen() || (access != ReadOnly && access != WriteOnly)) {
+        return false;
+    }
+
+    m_chunk.clear();
+    m_chunkOffset = 0;
+    m_segmentIndex = 0;
+    m_position = 0;
+    m_payloadSize = 0;
+    m_failed = false;
+
+    // Writes go to a temporary file that replaces the target on close, so
+    // a crash mid-write leaves the previous file intact
+    if (access == WriteOnly) {
+        if (!m_output.open(WriteOnly)) {
+            setErrorString(m_output.errorString());
+            return false;
+        }
+        if (!openForWriting()) {
+            m_output.cancelWriting();
+            m_output.commit();
+            return false;
+        }
+        return QIODevice::open(access);
+    }
+
+    // This device does the chunking; the file underneath need not buffer too
+    if (!m_file.open(ReadOnly | Unbuffered)) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+    if (!openForReading()) {
+        if (m_map) {
+            m_file.unmap(m_map);
+            m_map = nullptr;
+        }
+        m_file.close();
+        return false;
+    }
+    return QIODevice::open(access);
+}
+
+bool EncryptedDevice::openForReading() {
+    QDataStream in(&m_file);
+    in.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic;
+    in >> magic >> m_version;
+    if (in.status() != QDataStream::Ok || magic != FileMagic) {
+        setErrorString("Not a Sleepbook data file");
+        return false;
+    }
+
+    if (m_version == LegacyVersion) {
+        quint32 length;
+        in >> length;
+        m_key = m_sessionKey.legacyKey();
+        m_payloadSize = length == NullLength ? 0 : length;
+        return in.status() == QDataStream::Ok;
+    }
+    if (m_version != FormatVersion) {
+        setErrorString("Unsupported Sleepbook data file version");
+        return false;
+    }
+
+    quint32 flags, segmentSize;
+    quint64 length;
+    QByteArray salt(SaltSize, Qt::Uninitialized);
+    in >> flags >> segmentSize;
+    in.readRawData(salt.data(), SaltSize);
+    in >> length;
+    if (in.status() != QDataStream::Ok || (flags & ~KnownFlags) != 0 || segmentSize == 0
+        || segmentSize > MaxSegmentSize || length > quint64(std::numeric_limits<qint64>::max())) {
+        setErrorString("Corrupt Sleepbook data file header");
+        return false;
+    }
+
+    m_header = headerPrefix(flags, segmentSize, salt);
+    m_key = m_sessionKey.fileKey(salt);
+    m_flags = flags;
+    m_segmentSize = segmentSize;
+    m_payloadSize = qint64(length);
+
+    // Segments are copied out of a read-only mapping of the file, so they
+    // come from the page cache without a read call each; plain reads are
+    // the fallback where the file cannot be mapped
+    m_mapOffset = m_file.pos();
+    m_mapSize = m_file.size();
+    m_map = m_file.map(0, m_mapSize);
+
+    // An empty payload is still one authenticated segment; check it here so
+    // a truncated file cannot pass for an empty one
+    return m_payloadSize > 0 || readSegment(nullptr, 0);
+}
+
+bool EncryptedDevice::openForWriting() {
+    QByteArray salt = SessionKey::generateSalt();
+    m_version = FormatVersion;
+    m_flags = m_compress ? CompressedSegments : 0;
+    m_segmentSize = SegmentSize;
+    m_key = m_sessionKey.fileKey(salt);
+    m_header = headerPrefix(m_flags, SegmentSize, salt);
+
+    // The length is a placeholder until close()
+    QByteArray header = m_header + QByteArray(8, '\0');
+    if (m_output.write(header) != header.size()) {
+        setErrorString(m_output.errorString());
+        return false;
+    }
+    m_chunk.reserve(SegmentSize + ChaCha20Poly1305::TagSize);
+    return true;
+}
+
+void EncryptedDevice::close() {
+    if (!isOpen()) {
+        return;
+    }
+
+    if (openMode() & WriteOnly) {
+        if (!writeSegment(true)) {
+            m_failed = true;
+        } else {
+            uchar length[8];
+            qToBigEndian(quint64(m_payloadSize), length);
+            if (!m_output.seek(LengthOffset)
+                || m_output.write(reinterpret_cast<const char*>(length), 8) != 8) {
+                m_failed = true;
+            }
+        }
+
+        // Synced and renamed over the target only once complete
+        if (m_failed) {
+            m_output.cancelWriting();
+        }
+        if (!m_output.commit()) {
+            m_failed = true;
+        } else {
+            StorageSync::syncDirectory(QFileInfo(m_output.fileName()).path());
+        }
+    }
+
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_chunk = QByteArray();
+    m_scratch = QByteArray();
+    m_chunkOffset = 0;
+    QIODevice::close();
+}
+
+qint64 EncryptedDevice::bytesAvailable() const {
+    qint64 remaining = 0;
+    if (openMode() & ReadOnly) {
+        remaining = m_payloadSize - m_position + (m_chunk.size() - m_chunkOffset);
+    }
+    return QIODevice::bytesAvailable() + remaining;
+}
+
+qint64 EncryptedDevice::readData(char* data, qint64 maxSize) {
+    if (m_version == LegacyVersion) {
+        return readLegacy(data, maxSize);
+    }
+
+    qint64 done = 0;
+    while (done < maxSize) {
+        if (m_chunkOffset < m_chunk.size()) {
+            int take = int(qMin<qint64>(m_chunk.size() - m_chunkOffset, maxSize - done));
+            std::memcpy(data + done, m_chunk.constData() + m_chunkOffset, size_t(take));
+            m_chunkOffset += take;
+            done += take;
+            continue;
+        }
+        if (m_failed || m_position >= m_payloadSize) {
+            break;
+        }
+
+        qint64 length = qMin(m_segmentSize, m_payloadSize - m_position);
+        if (maxSize - done >= length) {
+            // The whole segment fits, so it is decrypted where it lands
+            if (!readSegment(data + done, length)) {
+                break;
+            }
+            done += length;
+        } else {
+            m_chunk.resize(int(length));
+            m_chunkOffset = 0;
+            if (!readSegment(m_chunk.data(), length)) {
+                m_chunk.clear();
+                break;
+            }
+        }
+    }
+
+    return m_failed && done == 0 ? -1 : done;
+}
+
+qint64 EncryptedDevice::readLegacy(char* data, qint64 maxSize) {
+    qint64 wanted = qMin(maxSize, m_payloadSize - m_position);
+    if (wanted <= 0) {
+        return 0;
+    }
+
+    qint64 read = m_file.read(data, wanted);
+    if (read < wanted) {
+        // Truncated file; hand back what there is and flag the rest
+        m_failed = true;
+        if (read <= 0) {
+            return -1;
+        }
+    }
+
+    DataEncryption::applyKeystream(data, read, m_key, m_position);
+    m_position += read;
+    return read;
+}
+
+qint64 EncryptedDevice::readFile(char* data, qint64 size) {
+    if (!m_map) {
+        return m_file.read(data, size);
+    }
+    qint64 take = qMin(size, m_mapSize - m_mapOffset);
+    std::memcpy(data, m_map + m_mapOffset, size_t(take));
+    m_mapOffset += take;
+    return take;
+}
+
+bool EncryptedDevice::atFileEnd() const {
+    return m_map ? m_mapOffset == m_mapSize : m_file.atEnd();
+}
+
+bool EncryptedDevice::readSegment(char* data, qint64 length) {
+    bool last = m_position + length == m_payloadSize;
+
+    // Without compression a segment is stored at its plaintext size
+    bool ok = true;
+    quint32 word = 0;
+    qint64 stored = length;
+    bool deflated = false;
+    if (m_flags & CompressedSegments) {
+        uchar field[4];
+        ok = readFile(reinterpret_cast<char*>(field), 4) == 4;
+        word = qFromBigEndian<quint32>(field);
+        deflated = (word & DeflatedBit) != 0;
+        stored = word & ~DeflatedBit;
+        ok = ok && (deflated ? stored > 0 && stored < length : stored == length);
+    }
+
+    // Raw segments are decrypted where they land; deflated ones go through
+    // the scratch buffer and are inflated into place
+    char* target = data;
+    if (deflated) {
+        m_scratch.resize(int(stored));
+        target = m_scratch.data();
+    }
+
+    uchar tag[ChaCha20Poly1305::TagSize];
+    if (!ok || (stored > 0 && readFile(target, stored) != stored)
+        || readFile(reinterpret_cast<char*>(tag), sizeof(tag)) != qint64(sizeof(tag))
+        || (last && !atFileEnd())) {
+        setErrorString("Sleepbook data file is truncated or has trailing data");
+        m_failed = true;
+        return false;
+    }
+
+    uchar nonce[ChaCha20Poly1305::NonceSize];
+    segmentNonce(last, nonce);
+    QByteArray aad = segmentAad(last, word);
+    if (!ChaCha20Poly1305::open(bytes(m_key), nonce, bytes(aad), aad.size(), target, stored,
+                                tag)) {
+        setErrorString("Sleepbook data file failed authentication");
+        m_failed = true;
+        return false;
+    }
+
+    if (deflated) {
+        QByteArray inflated = qUncompress(bytes(m_scratch), m_scratch.size());
+        if (inflated.size() != length) {
+            setErrorString("Sleepbook data file has a corrupt segment");
+            m_failed = true;
+            return false;
+        }
+        std::memcpy(data, inflated.constData(), size_t(length));
+    }
+
+    m_position += length;
+    ++m_segmentIndex;
+    return true;
+}
+
+qint64 EncryptedDevice::writeData(const char* data, qint64 maxSize) {
+    qint64 written = 0;
+    while (written < maxSize) {
+        // A full segment is only sealed once more data follows, so close()
+        // can flag whichever one turns out to be last
+        if (m_chunk.size() == m_segmentSize && !writeSegment(false)) {
+            m_failed = true;
+            return -1;
+        }
+
+        int take = int(qMin<qint64>(m_segmentSize - m_chunk.size(), maxSize - written));
+        m_chunk.append(data + written, take);
+        written += take;
+        m_payloadSize += take;
+    }
+    return written;
+}
+
+bool EncryptedDevice::writeSegment(bool last) {
+    int length = m_chunk.size();
+
+    // Deflate only when it actually saves space; random-looking segments
+    // are stored raw and still decrypt in place on the way back
+    QByteArray deflated;
+    if ((m_flags & CompressedSegments) && length > 0) {
+        deflated = qCompress(bytes(m_chunk), length, CompressionLevel);
+        if (deflated.size() >= length) {
+            deflated.clear();
+        }
+    }
+    QByteArray& segment = deflated.isEmpty() ? m_chunk : deflated;
+    int stored = segment.size();
+    quint32 word = deflated.isEmpty() ? quint32(stored) : quint32(stored) | DeflatedBit;
+
+    uchar nonce[ChaCha20Poly1305::NonceSize];
+    segmentNonce(last, nonce);
+    QByteArray aad = segmentAad(last, word);
+
+    // The tag goes right after the ciphertext, inside the reserved capacity
+    segment.resize(stored + ChaCha20Poly1305::TagSize);
+    ChaCha20Poly1305::seal(bytes(m_key), nonce, bytes(aad), aad.size(), segment.data(), stored,
+                           reinterpret_cast<uchar*>(segment.data() + stored));
+
+    bool ok = true;
+    if (m_flags & CompressedSegments) {
+        uchar field[4];
+        qToBigEndian(word, field);
+        ok = m_output.write(reinterpret_cast<const char*>(field), 4) == 4;
+    }
+    if (!ok || m_output.write(segment) != segment.size()) {
+        setErrorString(m_output.errorString());
+        return false;
+    }
+
+    m_position += length;
+    ++m_segmentIndex;
+    m_chunk.resize(0);
+    return true;
+}
+
+void EncryptedDevice::segmentNonce(bool last, uchar* nonce) const {
+    qToBigEndian(quint64(m_segmentIndex), nonce);
+    qToBigEndian(quint32(last ? 1 : 0), nonce + 8);
+}
+
+QByteArray EncryptedDevice::segmentAad(bool last, quint32 storedLength) const {
+    QByteArray aad = m_header;
+    if (m_flags & CompressedSegments) {
+        int offset = aad.size();
+        aad.resize(offset + 4);
+        qToBigEndian(storedLength, aad.data() + offset);
+    }
+    // The last segment also vouches for the total length
+    if (last) {
+        int offset = aad.size();
+        aad.resize(offset + 8);
+        qToBigEndian(quint64(m_payloadSize), aad.data() + offset);
+    }
+    return aad;
+}
@@ -0,0 +1,95 @@
+//created by drmrsthemonarch with ai effort
+#ifndef ENCRYPTEDDEVICE_H
+#define ENCRYPTEDDEVICE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QSaveFile>
+#include <QString>
+#include "sessionkey.h"
+
+// Sequential device over an "SLPP" file that encrypts and decrypts on the
+// fly, so a QDataStream can be streamed straight to or from disk.
+//
+// Version 2 files, which are what gets written, are a run of
+// ChaCha20-Poly1305 segments of SegmentSize bytes under a per-file key.
+// Each segment's nonce is its index plus a last-segment flag, and the last
+// one also authenticates the total length, so reordered, truncated or
+// extended files fail to read rather than yielding altered data. Whole
+// segments are decrypted straight into the caller's buffer when it has
+// room; otherwise one segment is buffered. The ciphertext is read from a
+// mapping of the file where it can be mapped. Writes go through a QSaveFile,
+// so the target is only ever replaced by a complete, synced file.
+//
+// Segments are deflated with zlib before sealing when that makes them
+// smaller, which the header flags; serialized history is mostly repeated
+// symptom names and shrinks several times over.
+//
+// Version 1 files (repeating-key XOR) are still read transparently,
+// decrypted in place in the caller's buffer.
+class EncryptedDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    EncryptedDevice(const QString& fileName, const SessionKey& key,
+                    QObject* parent = nullptr);
+    ~EncryptedDevice() override;
+
+    // ReadOnly or WriteOnly; ReadOnly fails on a missing or foreign file.
+    // A write is only committed by close(), and only if nothing failed.
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+    // Payload size from the header (reading) or written so far (writing)
+    qint64 payloadSize() const { return m_payloadSize; }
+    // Format version of the open file
+    quint32 formatVersion() const { return m_version; }
+    // False once any read or write failed, or a segment did not authenticate
+    bool isOk() const { return !m_failed; }
+    // Whether the next WriteOnly open compresses segments; on by default
+    void setCompressionEnabled(bool enabled) { m_compress = enabled; }
+
+    // Version written by this device
+    static const quint32 FormatVersion = 2;
+    static const int SegmentSize = 64 * 1024;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool openForReading();
+    bool openForWriting();
+    qint64 readLegacy(char* data, qint64 maxSize);
+    qint64 readFile(char* data, qint64 size);
+    bool atFileEnd() const;
+    bool readSegment(char* data, qint64 length);
+    bool writeSegment(bool last);
+    void segmentNonce(bool last, uchar* nonce) const;
+    QByteArray segmentAad(bool last, quint32 storedLength) const;
+
+    QFile m_file;
+    QSaveFile m_output;
+    SessionKey m_sessionKey;
+    QByteArray m_key;
+    QByteArray m_header;
+    QByteArray m_chunk;
+    QByteArray m_scratch;
+    int m_chunkOffset;
+    quint32 m_version;
+    quint32 m_flags;
+    qint64 m_segmentSize;
+    quint64 m_segmentIndex;
+    qint64 m_position;
+    qint64 m_payloadSize;
+    uchar* m_map;
+    qint64 m_mapSize;
+    qint64 m_mapOffset;
+    bool m_compress;
+    bool m_failed;
+};
+
+#endif // ENCRYPTEDDEVICE_H
@@ -0,0 +1,365 @@
+//created by drmrsthemonarch with ai effort
+#include "entrystore.h"
+#include "encrypteddevice.h"
+#include "storagesync.h"
+#include "summarycodec.h"
+#include "summaryjournal.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QSet>
+#include <QUuid>
+#include <QtConcurrent>
+#include <numeric>
+
+EntryStore::EntryStore(QObject* parent)
+    : QObject(parent), m_journalRecords(0), m_loading(false), m_openGeneration(0),
+      m_tableStale(true), m_statisticsStale(true) {
+}
+
+bool EntryStore::open(const QString& snapshotFile, const SessionKey& key) {
+    ++m_openGeneration;
+    m_loading = false;
+    return finishOpen(snapshotFile, key,
+                      loadSnapshot(snapshotFile, SummaryJournal::journalFileFor(snapshotFile),
+                                   key));
+}
+
+void EntryStore::openAsync(const QString& snapshotFile, const SessionKey& key) {
+    // Decryption, parsing and journal replay run on the thread pool; the
+    // result is applied here on the GUI thread unless close() or another
+    // open superseded it in the meantime
+    quint64 generation = ++m_openGeneration;
+    m_loading = true;
+    clear();
+    emit entriesReset();
+
+    auto* watcher = new QFutureWatcher<Snapshot>(this);
+    connect(watcher, &QFutureWatcher<Snapshot>::finished, this,
+            [this, watcher, generation, snapshotFile, key]() {
+                watcher->deleteLater();
+                if (generation != m_openGeneration) {
+                    return;
+                }
+                m_loading = false;
+                bool ok = finishOpen(snapshotFile, key, watcher->result());
+                emit opened(ok);
+            });
+    watcher->setFuture(QtConcurrent::run(&EntryStore::loadSnapshot, snapshotFile,
+                                         SummaryJournal::journalFileFor(snapshotFile),
+                                         key));
+}
+
+EntryStore::Snapshot EntryStore::loadSnapshot(const QString& snapshotFile,
+                                              const QString& journalFile,
+                                              const SessionKey& key) {
+    Snapshot snapshot;
+    bool legacyFormat = false;
+    bool legacyRecords = false;
+    bool needsMigration = false;
+
+    // Parsed as it is decrypted, without holding the whole payload
+    EncryptedDevice device(snapshotFile, key);
+    if (device.open(QIODevice::ReadOnly)) {
+        legacyFormat = device.formatVersion() != EncryptedDevice::FormatVersion;
+        bool parsed = true;
+        if (device.payloadSize() > 0 && SummaryCodec::isEncoded(device)) {
+            // Kept as records; maps are built per entry when first needed
+            SummaryRecords records;
+            parsed = SummaryCodec::read(device, records);
+            snapshot.entries = SummaryEntries(records);
+        } else if (device.payloadSize() > 0) {
+            QList<QVariantMap> entries;
+            QDataStream in(&device);
+            in.setVersion(QDataStream::Qt_5_15);
+            in >> entries;
+            legacyRecords = true;
+
+            // Check if entries have IDs, if not, add them (migration on-the-fly)
+            for (auto& entry : entries) {
+                if (!entry.contains("id")) {
+                    // This is an old entry without ID, generate one
+                    entry["id"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
+                    needsMigration = true;
+                }
+            }
+            snapshot.entries = SummaryEntries(entries);
+        }
+        // Never compact over a snapshot that failed authentication
+        if (!device.isOk() || !parsed) {
+            snapshot.entries = SummaryEntries();
+            snapshot.ok = false;
+            return snapshot;
+        }
+    }
+
+    // Apply saves, edits and deletes recorded since the last snapshot
+    bool legacyJournal = false;
+    bool damagedJournal = false;
+    int replayed = SummaryJournal::replay(journalFile, snapshot.entries, key, &legacyJournal,
+                                          &damagedJournal);
+
+    // Fold the journal back into the snapshot once it grows long enough,
+    // when ids had to be added, to move either file off the XOR format, to
+    // move a QVariantMap snapshot to the binary records it can hold, or to
+    // drop a torn record that later appends would otherwise sit behind
+    if (legacyRecords && !SummaryCodec::isEncodable(snapshot.entries.toList())) {
+        legacyRecords = false;
+    }
+    snapshot.journalRecords = replayed;
+    if (needsMigration || legacyFormat || legacyJournal || legacyRecords || damagedJournal
+        || replayed >= SummaryJournal::CompactionThreshold) {
+        snapshot.ok = SummaryJournal::compact(snapshotFile, journalFile,
+                                              snapshot.entries.toList(), key);
+        if (snapshot.ok) {
+            snapshot.journalRecords = 0;
+        }
+    }
+    return snapshot;
+}
+
+bool EntryStore::finishOpen(const QString& snapshotFile, const SessionKey& key,
+                            const Snapshot& snapshot) {
+    m_snapshotFile = snapshotFile;
+    m_journalFile = SummaryJournal::journalFileFor(snapshotFile);
+    m_key = key;
+    m_entries = snapshot.entries;
+    m_journalRecords = snapshot.journalRecords;
+
+    bool ok = snapshot.ok;
+    if (!m_details.open(QFileInfo(m_snapshotFile).path(), m_key)) {
+        ok = false;
+    }
+
+    invalidateTable();
+    emit entriesReset();
+    return ok;
+}
+
+void EntryStore::close() {
+    // Drops the result of an openAsync() still in flight
+    ++m_openGeneration;
+    m_loading = false;
+    clear();
+    emit entriesReset();
+}
+
+void EntryStore::clear() {
+    m_snapshotFile.clear();
+    m_journalFile.clear();
+    m_key.clear();
+    m_entries = SummaryEntries();
+    m_journalRecords = 0;
+    m_details.close();
+    invalidateTable();
+}
+
+QVariantMap EntryStore::entry(const QString& id) const {
+    int index = m_entries.indexOf(id);
+    return index >= 0 ? m_entries.at(index) : QVariantMap();
+}
+
+const SleepTable& EntryStore::table() const {
+    if (m_tableStale) {
+        m_table = SleepTable::fromEntries(m_entries, m_columnNames);
+        m_tableStale = false;
+    }
+    return m_table;
+}
+
+const SummaryStatistics& EntryStore::statistics() const {
+    if (m_statisticsStale) {
+        m_statistics = SummaryStatistics::fromTable(table());
+        m_statisticsStale = false;
+    }
+    return m_statistics;
+}
+
+void EntryStore::setColumnNames(const QStringList& names) {
+    m_columnNames = names;
+    invalidateTable();
+}
+
+bool EntryStore::upsert(const QVariantMap& entry) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (!SummaryJournal::append(m_journalFile, SummaryJournal::Operation::Upsert,
+                                entry, m_key)) {
+        return false;
+    }
+
+    if (!m_tableStale) {
+        m_table.upsertRow(entry);
+    }
+
+    QString id = entry.value("id").toString();
+    if (!m_statisticsStale) {
+        int index = m_entries.indexOf(id);
+        if (index >= 0) {
+            m_statistics.remove(m_entries.at(index));
+        }
+        m_statistics.add(entry);
+    }
+    if (m_entries.upsert(entry)) {
+        emit entryAdded(id);
+    } else {
+        emit entryChanged(id);
+    }
+    journalAppended();
+    return true;
+}
+
+bool EntryStore::merge(const QVariantMap& changes) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (!SummaryJournal::append(m_journalFile, SummaryJournal::Operation::Merge,
+                                changes, m_key)) {
+        return false;
+    }
+
+    // Same semantics as the journal replay: merge fields, insert if missing
+    QString id = changes.value("id").toString();
+    if (!m_statisticsStale && m_entries.contains(id)) {
+        m_statistics.remove(m_entries.at(m_entries.indexOf(id)));
+    }
+    bool added = m_entries.merge(changes);
+    const QVariantMap& merged = m_entries.at(m_entries.indexOf(id));
+    if (!m_tableStale) {
+        m_table.upsertRow(merged);
+    }
+    if (!m_statisticsStale) {
+        m_statistics.add(merged);
+    }
+    if (added) {
+        emit entryAdded(id);
+    } else {
+        emit entryChanged(id);
+    }
+    journalAppended();
+    return true;
+}
+
+bool EntryStore::remove(const QString& id) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    QVariantMap removed;
+    removed["id"] = id;
+    if (!SummaryJournal::append(m_journalFile, SummaryJournal::Operation::Remove,
+                                removed, m_key)) {
+        return false;
+    }
+
+    int index = m_entries.indexOf(id);
+    if (index >= 0 && !m_statisticsStale) {
+        m_statistics.remove(m_entries.at(index));
+    }
+    if (m_entries.remove(id)) {
+        if (!m_tableStale) {
+            m_table.removeRow(QUuid::fromString(id));
+        }
+        emit entryRemoved(id);
+    }
+    journalAppended();
+    return true;
+}
+
+void EntryStore::journalAppended() {
+    // Folded into the snapshot once it reaches the replay threshold, so the
+    // next launch never has more than that to replay after a crash
+    if (++m_journalRecords >= SummaryJournal::CompactionThreshold
+        && SummaryJournal::compact(m_snapshotFile, m_journalFile, m_entries.toList(), m_key)) {
+        m_journalRecords = 0;
+    }
+}
+
+EntryStore::ImportReport EntryStore::importEntries(const QVector<SleepEntry>& entries) {
+    ImportReport report;
+    if (!isOpen()) {
+        report.ok = false;
+        return report;
+    }
+
+    QVector<int> added;
+    added.reserve(entries.size());
+    QSet<QUuid> seen;
+    for (int i = 0; i < entries.size(); ++i) {
+        const QUuid& id = entries[i].id;
+        if (seen.contains(id)) {
+            ++report.duplicates;
+        } else if (m_entries.contains(id.toString(QUuid::WithoutBraces))) {
+            seen.insert(id);
+            ++report.existing;
+        } else {
+            seen.insert(id);
+            added.append(i);
+        }
+    }
+    if (added.isEmpty()) {
+        return report;
+    }
+
+    // Serialized across the pool; writeMany seals them the same way
+    QVector<QPair<QUuid, QByteArray>> records(added.size());
+    QPair<QUuid, QByteArray>* out = records.data();
+    QVector<int> indexes(added.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&entries, &added, out](int& i) {
+        const SleepEntry& entry = entries[added[i]];
+        out[i] = qMakePair(entry.id, entry.toDetailRecord());
+    });
+
+    // Details are on disk before the summary that points at them
+    StorageBatch batch;
+    if (!m_details.writeMany(records) || !batch.commit()) {
+        report.ok = false;
+        return report;
+    }
+
+    QList<QVariantMap> merged = m_entries.toList();
+    merged.reserve(merged.size() + added.size());
+    for (int i : qAsConst(added)) {
+        merged.append(entries[i].toVariantMap());
+    }
+    if (!SummaryJournal::compact(m_snapshotFile, m_journalFile, merged, m_key)) {
+        report.ok = false;
+        return report;
+    }
+
+    m_entries = SummaryEntries(merged);
+    m_journalRecords = 0;
+    invalidateTable();
+    emit entriesReset();
+    report.added = added.size();
+    return report;
+}
+
+Reindex::Report EntryStore::reindex(bool repair) {
+    Reindex::Report report;
+    if (!isOpen()) {
+        report.ok = false;
+        return report;
+    }
+
+    QList<QVariantMap> rebuilt;
+    report = Reindex::run(m_details, m_entries, repair ? &rebuilt : nullptr);
+    if (!repair || !report.ok || (report.missing == 0 && report.mismatched == 0)) {
+        return report;
+    }
+
+    // The journal is folded in by writing the snapshot, as on compaction
+    if (!SummaryJournal::compact(m_snapshotFile, m_journalFile, rebuilt, m_key)) {
+        report.ok = false;
+        return report;
+    }
+    m_entries = SummaryEntries(rebuilt);
+    m_journalRecords = 0;
+    invalidateTable();
+    emit entriesReset();
+    return report;
+}
@@ -0,0 +1,116 @@
+//created by drmrsthemonarch with ai effort
+#ifndef ENTRYSTORE_H
+#define ENTRYSTORE_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+#include "detailstore.h"
+#include "reindex.h"
+#include "sleeptable.h"
+#include "summarystatistics.h"
+#include "summaryentries.h"
+
+// Session-scoped, in-memory copy of the summary history.
+// Loaded once at login and kept current on every save, edit and delete, so
+// tabs read from memory instead of decrypting symptom_history.dat again.
+// Snapshot rows are only turned into QVariantMaps when one is asked for;
+// the table is built straight from the record block.
+class EntryStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit EntryStore(QObject* parent = nullptr);
+
+    bool open(const QString& snapshotFile, const SessionKey& key);
+    // Loads off the GUI thread; emits opened() and entriesReset() when done
+    void openAsync(const QString& snapshotFile, const SessionKey& key);
+    void close();
+    bool isOpen() const { return !m_snapshotFile.isEmpty(); }
+    bool isLoading() const { return m_loading; }
+
+    // Decodes every entry not yet decoded
+    QList<QVariantMap> entries() const { return m_entries.toList(); }
+    QVariantMap entry(const QString& id) const;
+    bool contains(const QString& id) const { return m_entries.contains(id); }
+
+    // Columnar copy for plots and export, kept sorted by date. Built on
+    // first use, then patched row by row as entries change.
+    const SleepTable& table() const;
+    void setColumnNames(const QStringList& names);
+
+    // Count, mean, spread, extremes and quartiles per column. Built with the
+    // table, then updated entry by entry; no edit or delete rescans it.
+    const SummaryStatistics& statistics() const;
+
+    // Per-night detail records, packed next to the snapshot
+    DetailStore& details() { return m_details; }
+
+    // Write-through: the journal is appended first, then memory is updated
+    bool upsert(const QVariantMap& entry);
+    bool merge(const QVariantMap& changes);
+    bool remove(const QString& id);
+
+    struct ImportReport {
+        bool ok = true;
+        int added = 0;
+        // Repeats of an id earlier in the same import
+        int duplicates = 0;
+        // Ids the history already had
+        int existing = 0;
+    };
+
+    // Bulk load, e.g. from a CSV import: all detail records in one synced
+    // append, then one snapshot rewrite instead of a journal record per
+    // entry. Entries whose id is already stored, or repeated within the
+    // import, are left out; ok is false if nothing could be written.
+    ImportReport importEntries(const QVector<SleepEntry>& entries);
+
+    // Rebuilds the pack index and checks the summary against the details.
+    // With repair, a summary that disagrees is replaced by the one derived
+    // from the details and written out as a fresh snapshot.
+    Reindex::Report reindex(bool repair);
+
+signals:
+    void opened(bool ok);
+    void entriesReset();
+    void entryAdded(const QString& id);
+    void entryChanged(const QString& id);
+    void entryRemoved(const QString& id);
+
+private:
+    struct Snapshot {
+        SummaryEntries entries;
+        // Records left in the journal after loading
+        int journalRecords = 0;
+        bool ok = true;
+    };
+
+    // Pure file work, safe to run on any thread
+    static Snapshot loadSnapshot(const QString& snapshotFile, const QString& journalFile,
+                                 const SessionKey& key);
+    bool finishOpen(const QString& snapshotFile, const SessionKey& key,
+                    const Snapshot& snapshot);
+    void clear();
+    void journalAppended();
+    void invalidateTable() { m_tableStale = m_statisticsStale = true; }
+
+    QString m_snapshotFile;
+    QString m_journalFile;
+    SessionKey m_key;
+    SummaryEntries m_entries;
+    int m_journalRecords;
+    bool m_loading;
+    quint64 m_openGeneration;
+    DetailStore m_details;
+    QStringList m_columnNames;
+    mutable SleepTable m_table;
+    mutable bool m_tableStale;
+    mutable SummaryStatistics m_statistics;
+    mutable bool m_statisticsStale;
+};
+
+#endif // ENTRYSTORE_H
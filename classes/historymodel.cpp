@@ -0,0 +1,193 @@
+//created by drmrsthemonarch with ai effort
+#include "historymodel.h"
+#include "detailloader.h"
+#include "entrystore.h"
+#include <QTimer>
+
+namespace {
+// A few screens' worth of rows; scrolling back is served from memory
+const int DetailCacheSize = 512;
+}
+
+HistoryModel::HistoryModel(EntryStore* store, QObject* parent)
+    : QAbstractTableModel(parent), m_store(store), m_loader(new DetailLoader(this)),
+      m_rowCount(0), m_times(DetailCacheSize), m_fetchScheduled(false) {
+    connect(m_loader, &DetailLoader::entriesLoaded, this, &HistoryModel::onEntriesLoaded);
+    connect(m_loader, &DetailLoader::finished, this, &HistoryModel::onLoadFinished);
+}
+
+void HistoryModel::reload() {
+    beginResetModel();
+    m_loader->cancel();
+    m_pending.clear();
+    m_requested.clear();
+    m_times.clear();
+    m_rowCount = m_store->table().rowCount();
+    endResetModel();
+}
+
+void HistoryModel::setSymptoms(const QList<Symptom>& symptoms) {
+    m_symptoms = symptoms;
+    if (m_rowCount > 0) {
+        emit dataChanged(index(0, SymptomsColumn), index(m_rowCount - 1, SymptomsColumn));
+    }
+}
+
+int HistoryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int HistoryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant HistoryModel::data(const QModelIndex& index, int role) const {
+    const SleepTable& table = m_store->table();
+    // Guard against the store changing before the next reload()
+    if (!index.isValid() || index.row() >= m_rowCount || m_rowCount != table.rowCount()) {
+        return QVariant();
+    }
+
+    // The table is sorted ascending by date; show it newest first
+    int row = m_rowCount - 1 - index.row();
+
+    if (role == Qt::UserRole && index.column() == DateColumn) {
+        return table.id(row).toString(QUuid::WithoutBraces);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case DateColumn:
+        return table.date(row).toString("yyyy-MM-dd");
+    case DurationColumn:
+        return QString::number(table.sleepDuration()[row], 'f', 1) + " hrs";
+    case BedtimeColumn: {
+        const Times* times = timesFor(row);
+        if (!times) {
+            return QString();
+        }
+        return times->found ? times->bedtime.toString("HH:mm") : QString("-");
+    }
+    case WakeTimeColumn: {
+        const Times* times = timesFor(row);
+        if (!times) {
+            return QString();
+        }
+        return times->found ? times->waketime.toString("HH:mm") : QString("-");
+    }
+    case SymptomsColumn:
+        return symptomsText(row);
+    }
+    return QVariant();
+}
+
+QVariant HistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case DateColumn:
+        return "Date";
+    case DurationColumn:
+        return "Sleep Duration";
+    case BedtimeColumn:
+        return "Bedtime";
+    case WakeTimeColumn:
+        return "Wake Time";
+    case SymptomsColumn:
+        return "Symptoms";
+    }
+    return QVariant();
+}
+
+const HistoryModel::Times* HistoryModel::timesFor(int tableRow) const {
+    const SleepTable& table = m_store->table();
+    QUuid id = table.id(tableRow);
+
+    if (Times* cached = m_times.object(id)) {
+        return cached;
+    }
+
+    // Pack records are fetched in the background with the rest of the
+    // visible rows; the cell shows blank until they arrive
+    if (m_store->details().contains(id)) {
+        m_pending.insert(id, tableRow);
+        if (!m_fetchScheduled) {
+            m_fetchScheduled = true;
+            QTimer::singleShot(0, this, &HistoryModel::fetchPending);
+        }
+        return nullptr;
+    }
+
+    // No details for this night; cached so the row is not looked up per
+    // paint. Files from older versions are moved into the pack after
+    // login, and the model is reloaded once they are.
+    m_times.insert(id, new Times);
+    return m_times.object(id);
+}
+
+void HistoryModel::fetchPending() {
+    m_fetchScheduled = false;
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // A new load replaces the one in flight, so it asks for everything
+    // still outstanding, not just the rows added since
+    const QList<QUuid> ids = m_pending.keys();
+    m_requested = QSet<QUuid>(ids.begin(), ids.end());
+    m_loader->load(m_store->details().planRead(ids.toVector()));
+}
+
+void HistoryModel::onEntriesLoaded(const QVector<SleepEntry>& entries) {
+    for (const SleepEntry& entry : entries) {
+        auto* times = new Times;
+        times->bedtime = entry.bedtime;
+        times->waketime = entry.waketime;
+        times->found = true;
+        m_times.insert(entry.id, times);
+        timesChanged(entry.id);
+    }
+}
+
+void HistoryModel::onLoadFinished() {
+    // Anything the pack could not deliver shows as missing
+    for (const QUuid& id : qAsConst(m_requested)) {
+        if (m_pending.contains(id)) {
+            m_times.insert(id, new Times);
+            timesChanged(id);
+        }
+    }
+    m_requested.clear();
+}
+
+void HistoryModel::timesChanged(const QUuid& id) {
+    auto it = m_pending.constFind(id);
+    if (it == m_pending.constEnd()) {
+        return;
+    }
+    int row = m_rowCount - 1 - it.value();
+    m_pending.erase(it);
+    emit dataChanged(index(row, BedtimeColumn), index(row, WakeTimeColumn));
+}
+
+QString HistoryModel::symptomsText(int tableRow) const {
+    const SleepTable& table = m_store->table();
+
+    QStringList symptomList;
+    for (const Symptom& s : m_symptoms) {
+        int column = table.columnIndex(s.getName());
+        double value = column >= 0 ? table.column(column)[tableRow] : 0.0;
+        if (value > 0) {
+            if (s.getType() == SymptomType::Binary) {
+                symptomList << s.getName();
+            } else {
+                symptomList << QString("%1 (%2)").arg(s.getName()).arg(value);
+            }
+        }
+    }
+    return symptomList.join(", ");
+}
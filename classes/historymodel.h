@@ -0,0 +1,69 @@
+//created by drmrsthemonarch with ai effort
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTime>
+#include <QUuid>
+#include "sleepentry.h"
+#include "symptom.h"
+
+class DetailLoader;
+class EntryStore;
+
+// Table model behind the History tab, newest night first.
+// Date, duration and symptoms come straight from the EntryStore table.
+// Bedtime and wake time need the night's detail record, which is only read
+// when the view asks for a visible cell and is then kept in a small LRU
+// cache, so opening the tab costs the same for 50 nights as for 5,000.
+// Those reads are batched and run on a DetailLoader; the cells fill in as
+// the records arrive.
+class HistoryModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { DateColumn, DurationColumn, BedtimeColumn, WakeTimeColumn, SymptomsColumn, ColumnCount };
+
+    explicit HistoryModel(EntryStore* store, QObject* parent = nullptr);
+
+    // Re-reads the row count from the store and drops cached details
+    void reload();
+    void setSymptoms(const QList<Symptom>& symptoms);
+
+    // Column 0 also carries the entry id as Qt::UserRole
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+    struct Times {
+        QTime bedtime;
+        QTime waketime;
+        bool found = false;
+    };
+
+    const Times* timesFor(int tableRow) const;
+    QString symptomsText(int tableRow) const;
+    void fetchPending();
+    void onEntriesLoaded(const QVector<SleepEntry>& entries);
+    void onLoadFinished();
+    void timesChanged(const QUuid& id);
+
+    EntryStore* m_store;
+    DetailLoader* m_loader;
+    QList<Symptom> m_symptoms;
+    int m_rowCount;
+    mutable QCache<QUuid, Times> m_times;
+    // Table rows of records requested but not yet delivered
+    mutable QHash<QUuid, int> m_pending;
+    mutable bool m_fetchScheduled;
+    QSet<QUuid> m_requested;
+};
+
+#endif // HISTORYMODEL_H
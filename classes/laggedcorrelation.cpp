@@ -0,0 +1,293 @@
+//created by drmrsthemonarch with ai effort
+#include "laggedcorrelation.h"
+#include <QtConcurrent>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <numeric>
+
+namespace {
+typedef std::complex<double> Complex;
+
+const double Pi = 3.14159265358979323846;
+
+// A coefficient from fewer overlapping days says nothing
+const int MinPairs = 3;
+
+// Days times lags below which each lag is summed directly; above it the
+// transforms, whose cost barely depends on the number of lags, win
+const qint64 DirectLimit = qint64(1) << 18;
+
+// Relative size under which a variance is rounding noise from the
+// transforms and the coefficient is left undefined
+const double VarianceTolerance = 1e-9;
+
+// A series centred on the mean of its recorded days, with the mask and the
+// masked values and squares the sums are built from
+struct Masked {
+    QVector<double> mask;
+    QVector<double> values;
+    QVector<double> squares;
+};
+
+Masked masked(const DailySeries& series, int length) {
+    double sum = 0.0;
+    int count = 0;
+    for (int day = 0; day < length; ++day) {
+        if (series.present[day]) {
+            sum += series.values[day];
+            ++count;
+        }
+    }
+    double mean = count > 0 ? sum / count : 0.0;
+
+    Masked out;
+    out.mask.fill(0.0, length);
+    out.values.fill(0.0, length);
+    out.squares.fill(0.0, length);
+    for (int day = 0; day < length; ++day) {
+        if (series.present[day]) {
+            double value = series.values[day] - mean;
+            out.mask[day] = 1.0;
+            out.values[day] = value;
+            out.squares[day] = value * value;
+        }
+    }
+    return out;
+}
+
+// Sums over the pairs of recorded days at one lag
+struct LagSums {
+    double pairs = 0.0;
+    double cause = 0.0;
+    double effect = 0.0;
+    double causeSquares = 0.0;
+    double effectSquares = 0.0;
+    double products = 0.0;
+};
+
+double coefficient(const LagSums& sums, int* pairs) {
+    *pairs = int(qRound64(sums.pairs));
+    if (*pairs < MinPairs) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double n = *pairs;
+    double causeVariance = n * sums.causeSquares - sums.cause * sums.cause;
+    double effectVariance = n * sums.effectSquares - sums.effect * sums.effect;
+    if (causeVariance <= VarianceTolerance * n * sums.causeSquares
+        || effectVariance <= VarianceTolerance * n * sums.effectSquares) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double r = (n * sums.products - sums.cause * sums.effect)
+               / std::sqrt(causeVariance * effectVariance);
+    return qBound(-1.0, r, 1.0);
+}
+
+LaggedCorrelation::Curve sumDirectly(const Masked& x, const Masked& y, int minLag, int maxLag) {
+    const int length = x.mask.size();
+    LaggedCorrelation::Curve curve;
+    curve.minLag = minLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        LagSums sums;
+        for (int t = qMax(0, -lag); t < qMin(length, length - lag); ++t) {
+            int u = t + lag;
+            if (x.mask[t] != 0.0 && y.mask[u] != 0.0) {
+                sums.pairs += 1.0;
+                sums.cause += x.values[t];
+                sums.effect += y.values[u];
+                sums.causeSquares += x.squares[t];
+                sums.effectSquares += y.squares[u];
+                sums.products += x.values[t] * y.values[u];
+            }
+        }
+        int pairs;
+        curve.coefficients.append(coefficient(sums, &pairs));
+        curve.pairs.append(pairs);
+    }
+    return curve;
+}
+
+// Iterative radix-2 transform of a power-of-two size; the inverse is left
+// unscaled. twiddles[k] = exp(-2 pi i k / size) for k < size / 2.
+void fft(QVector<Complex>& data, const QVector<Complex>& twiddles, bool inverse) {
+    const int size = data.size();
+    Complex* a = data.data();
+    for (int i = 1, j = 0; i < size; ++i) {
+        int bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (int length = 2; length <= size; length <<= 1) {
+        const int half = length / 2;
+        const int step = size / length;
+        for (int start = 0; start < size; start += length) {
+            for (int k = 0; k < half; ++k) {
+                Complex w = inverse ? std::conj(twiddles[k * step]) : twiddles[k * step];
+                Complex odd = a[start + k + half] * w;
+                a[start + k + half] = a[start + k] - odd;
+                a[start + k] += odd;
+            }
+        }
+    }
+}
+
+QVector<Complex> spectrum(const QVector<double>& values, int size,
+                          const QVector<Complex>& twiddles) {
+    QVector<Complex> data(size);
+    for (int i = 0; i < values.size(); ++i) {
+        data[i] = values[i];
+    }
+    fft(data, twiddles, false);
+    return data;
+}
+
+struct Spectra {
+    QVector<Complex> mask;
+    QVector<Complex> values;
+    QVector<Complex> squares;
+};
+
+Spectra spectra(const Masked& series, int size, const QVector<Complex>& twiddles) {
+    return {spectrum(series.mask, size, twiddles), spectrum(series.values, size, twiddles),
+            spectrum(series.squares, size, twiddles)};
+}
+
+// Two cross-correlations from one inverse transform: both are real, so
+// the first comes back as the real part and the second as the imaginary
+void correlatePair(const QVector<Complex>& a1, const QVector<Complex>& b1,
+                   const QVector<Complex>& a2, const QVector<Complex>& b2,
+                   const QVector<Complex>& twiddles, QVector<double>& first,
+                   QVector<double>& second) {
+    const int size = a1.size();
+    const Complex i(0.0, 1.0);
+    QVector<Complex> data(size);
+    for (int k = 0; k < size; ++k) {
+        data[k] = std::conj(a1[k]) * b1[k] + i * (std::conj(a2[k]) * b2[k]);
+    }
+    fft(data, twiddles, true);
+    first.resize(size);
+    second.resize(size);
+    for (int k = 0; k < size; ++k) {
+        first[k] = data[k].real() / size;
+        second[k] = data[k].imag() / size;
+    }
+}
+
+LaggedCorrelation::Curve sumByTransform(const Spectra& x, const Spectra& y, int minLag,
+                                        int maxLag, const QVector<Complex>& twiddles) {
+    // sum over t of a[t] * b[t + lag] is the inverse of conj(A) * B, with
+    // negative lags wrapped to the end
+    QVector<double> pairs, cause, causeSquares, effect, effectSquares, products;
+    correlatePair(x.mask, y.mask, x.values, y.mask, twiddles, pairs, cause);
+    correlatePair(x.squares, y.mask, x.mask, y.values, twiddles, causeSquares, effect);
+    correlatePair(x.mask, y.squares, x.values, y.values, twiddles, effectSquares, products);
+
+    const int size = twiddles.size() * 2;
+    LaggedCorrelation::Curve curve;
+    curve.minLag = minLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        int k = lag >= 0 ? lag : size + lag;
+        LagSums sums;
+        sums.pairs = pairs[k];
+        sums.cause = cause[k];
+        sums.effect = effect[k];
+        sums.causeSquares = causeSquares[k];
+        sums.effectSquares = effectSquares[k];
+        sums.products = products[k];
+        int count;
+        curve.coefficients.append(coefficient(sums, &count));
+        curve.pairs.append(count);
+    }
+    return curve;
+}
+}
+
+DailySeries DailySeries::fromTable(const SleepTableView& table, const QString& column) {
+    DailySeries series;
+    const int rows = table.rowCount();
+    if (rows == 0) {
+        return series;
+    }
+
+    const qint64* days = table.days();
+    series.firstDay = days[0];
+    const int length = int(days[rows - 1] - days[0] + 1);
+    series.values.fill(0.0, length);
+    series.present.fill(0, length);
+
+    if (column == "sleep_duration") {
+        const double* values = table.sleepDuration();
+        for (int row = 0; row < rows; ++row) {
+            int day = int(days[row] - series.firstDay);
+            series.values[day] = values[row];
+            series.present[day] = 1;
+        }
+        return series;
+    }
+
+    int index = table.columnIndex(column);
+    if (index < 0) {
+        return series;
+    }
+    const double* values = table.column(index);
+    for (int row = 0; row < rows; ++row) {
+        if (table.isPresent(index, row)) {
+            int day = int(days[row] - series.firstDay);
+            series.values[day] += values[row];
+            series.present[day] = 1;
+        }
+    }
+    return series;
+}
+
+QVector<LaggedCorrelation::Curve> LaggedCorrelation::compute(const QVector<DailySeries>& causes,
+                                                             const DailySeries& effect,
+                                                             int minLag, int maxLag) {
+    // Series from the same table share their first day and length
+    int length = effect.values.size();
+    for (const DailySeries& cause : causes) {
+        length = qMin(length, cause.values.size());
+    }
+    maxLag = qMax(minLag, maxLag);
+
+    QVector<Curve> curves(causes.size());
+    if (causes.isEmpty()) {
+        return curves;
+    }
+    Masked y = masked(effect, length);
+    Curve* out = curves.data();
+    QVector<int> indexes(causes.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    const qint64 lags = qint64(maxLag) - minLag + 1;
+    if (lags * length <= DirectLimit) {
+        QtConcurrent::blockingMap(indexes, [&](int& i) {
+            out[i] = sumDirectly(masked(causes[i], length), y, minLag, maxLag);
+        });
+        return curves;
+    }
+
+    // Zero padding past the longest lag keeps the circular correlation
+    // from wrapping one end of the history onto the other
+    const int reach = qMax(qAbs(minLag), qAbs(maxLag));
+    int size = 2;
+    while (size < length + reach) {
+        size <<= 1;
+    }
+    QVector<Complex> twiddles(size / 2);
+    for (int k = 0; k < size / 2; ++k) {
+        twiddles[k] = std::polar(1.0, -2.0 * Pi * k / size);
+    }
+
+    Spectra effectSpectra = spectra(y, size, twiddles);
+    QtConcurrent::blockingMap(indexes, [&](int& i) {
+        Spectra causeSpectra = spectra(masked(causes[i], length), size, twiddles);
+        out[i] = sumByTransform(causeSpectra, effectSpectra, minLag, maxLag, twiddles);
+    });
+    return curves;
+}
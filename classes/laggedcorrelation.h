@@ -0,0 +1,45 @@
+//created by drmrsthemonarch with ai effort
+#ifndef LAGGEDCORRELATION_H
+#define LAGGEDCORRELATION_H
+
+#include <QString>
+#include <QVector>
+#include "sleeptable.h"
+
+// One slot per calendar day from the first night of a table to the last.
+// Days with no entry, or whose entries did not record the column, are
+// marked absent rather than read as zero.
+struct DailySeries {
+    qint64 firstDay = 0;
+    QVector<double> values;
+    QVector<char> present;
+
+    // Symptom values of entries sharing a night are summed; sleep_duration
+    // is taken from the last entry saved for the night
+    static DailySeries fromTable(const SleepTableView& table, const QString& column);
+};
+
+// Correlation of a cause on day t with an effect on day t + lag, for every
+// lag in a range, over the pairs of days on which both were recorded.
+// Each lag needs six sums over those pairs (count, both sums, both sums of
+// squares and the cross product); each sum is a cross-correlation of masked
+// series, so long histories get all lags at once from FFTs, while short
+// ones are summed directly.
+class LaggedCorrelation {
+public:
+    struct Curve {
+        int minLag = 0;
+        // NaN where fewer than three pairs overlap or either side is constant
+        QVector<double> coefficients;
+        QVector<int> pairs;
+
+        int lagAt(int index) const { return minLag + index; }
+    };
+
+    // One curve per cause, in the same order; the effect's transforms are
+    // shared and the causes run on the thread pool
+    static QVector<Curve> compute(const QVector<DailySeries>& causes, const DailySeries& effect,
+                                  int minLag, int maxLag);
+};
+
+#endif // LAGGEDCORRELATION_H
@@ -0,0 +1,232 @@
+//created by drmrsthemonarch with ai effort
+#include "legacymigration.h"
+#include "dataencryption.h"
+#include "entrystore.h"
+#include "storagesync.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimer>
+#include <QtConcurrent>
+
+namespace {
+const quint32 ManifestMagic = 0x534C504D; // "SLPM" (Sleep Migration)
+
+// Files moved per synced batch; the event loop runs between batches
+const int BatchSize = 64;
+}
+
+LegacyMigration::LegacyMigration(EntryStore* store, QObject* parent)
+    : QObject(parent), m_store(store), m_migrated(0), m_running(false), m_generation(0) {
+}
+
+QString LegacyMigration::manifestFileFor(const QString& directory) {
+    return directory + "/migration.manifest";
+}
+
+bool LegacyMigration::isComplete(const QString& directory) {
+    QFile file(manifestFileFor(directory));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, version;
+    in >> magic >> version;
+    return in.status() == QDataStream::Ok && magic == ManifestMagic && version >= Version;
+}
+
+void LegacyMigration::start(const QString& directory, const SessionKey& key) {
+    cancel();
+    quint64 generation = ++m_generation;
+    m_running = true;
+    m_directory = directory;
+
+    // Listing and decrypting run on the thread pool; the store is only
+    // touched here on the GUI thread, unless cancel() or another start()
+    // superseded the scan in the meantime
+    auto* watcher = new QFutureWatcher<Scan>(this);
+    connect(watcher, &QFutureWatcher<Scan>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        m_scan = watcher->result();
+        if (m_scan.upToDate) {
+            m_scan = Scan();
+            m_running = false;
+            return;
+        }
+
+        // Entries saved by the first format got their ids when ids were
+        // introduced, but their details stayed under the date; the earliest
+        // such entry of a night takes that night's file. An entry whose own
+        // sleep_<uuid>.dat is in this scan already has its details, and
+        // date-named files sort before those, so it must not take one.
+        QSet<QUuid> looseIds;
+        for (const LegacyFile& file : qAsConst(m_scan.files)) {
+            if (!file.id.isNull()) {
+                looseIds.insert(file.id);
+            }
+        }
+        const SleepTable& table = m_store->table();
+        for (int row = 0; row < table.rowCount(); ++row) {
+            QUuid id = table.id(row);
+            qint64 day = table.date(row).toJulianDay();
+            if (!m_store->details().contains(id) && !looseIds.contains(id)
+                && !m_detailless.contains(day)) {
+                m_detailless.insert(day, id);
+            }
+        }
+        applyBatch(generation, 0);
+    });
+    watcher->setFuture(QtConcurrent::run(&LegacyMigration::scan, directory, key));
+}
+
+void LegacyMigration::cancel() {
+    ++m_generation;
+    m_running = false;
+    m_scan = Scan();
+    m_detailless.clear();
+    m_migrated = 0;
+}
+
+LegacyMigration::Scan LegacyMigration::scan(const QString& directory, const SessionKey& key) {
+    Scan result;
+    if (isComplete(directory)) {
+        result.upToDate = true;
+        return result;
+    }
+
+    // Sorted by name, so date-named files come in date order
+    QDir dir(directory);
+    const QStringList names =
+        dir.entryList(QStringList() << "sleep_*.dat", QDir::Files, QDir::Name);
+
+    QVector<LegacyFile> files;
+    for (const QString& name : names) {
+        QString stem = name.mid(6, name.size() - 10);
+        LegacyFile file;
+        file.path = dir.filePath(name);
+        file.id = QUuid::fromString(stem);
+        if (file.id.isNull() && !QDate::fromString(stem, "yyyy-MM-dd").isValid()) {
+            continue;
+        }
+        files.append(file);
+    }
+
+    // Every file is a separate decryption; spread them over all cores
+    QtConcurrent::blockingMap(files, [&key](LegacyFile& file) {
+        file.data = DataEncryption::loadEncrypted(file.path, key);
+    });
+
+    for (const LegacyFile& file : files) {
+        if (file.data.isEmpty()) {
+            ++result.unreadable;
+        } else {
+            result.files.append(file);
+        }
+    }
+    return result;
+}
+
+void LegacyMigration::applyBatch(quint64 generation, int first) {
+    if (generation != m_generation) {
+        return;
+    }
+    if (!m_store->isOpen()) {
+        cancel();
+        return;
+    }
+
+    // One sync for the batch; no file is removed before the records that
+    // replace it are on disk
+    int last = qMin(first + BatchSize, m_scan.files.size());
+    StorageBatch batch;
+    QStringList moved;
+    for (int i = first; i < last; ++i) {
+        if (applyFile(m_scan.files[i])) {
+            moved.append(m_scan.files[i].path);
+        } else {
+            ++m_scan.unreadable;
+        }
+        m_scan.files[i].data.clear();
+    }
+
+    // A failed sync leaves the files for the next login to try again
+    if (!batch.commit()) {
+        cancel();
+        return;
+    }
+    for (const QString& path : moved) {
+        QFile::remove(path);
+    }
+    m_migrated += moved.size();
+
+    if (last < m_scan.files.size()) {
+        QTimer::singleShot(0, this, [this, generation, last]() { applyBatch(generation, last); });
+    } else {
+        finish();
+    }
+}
+
+bool LegacyMigration::applyFile(const LegacyFile& file) {
+    DetailStore& details = m_store->details();
+
+    // Already a detail record under its id, saved next to its summary entry
+    if (!file.id.isNull()) {
+        return details.contains(file.id) || details.write(file.id, file.data);
+    }
+
+    // The first format had the same layout without the id
+    SleepEntry entry{QUuid()};
+    QDataStream in(file.data);
+    in.setVersion(QDataStream::Qt_5_15);
+    in >> entry.timestamp >> entry.date >> entry.bedtime >> entry.waketime >> entry.hours
+       >> entry.notes >> entry.symptomData;
+    if (in.status() != QDataStream::Ok || !entry.date.isValid()) {
+        return false;
+    }
+
+    auto summary = m_detailless.find(entry.date.toJulianDay());
+    bool known = summary != m_detailless.end();
+    entry.id = known ? summary.value() : QUuid::createUuid();
+    if (known) {
+        m_detailless.erase(summary);
+    }
+
+    if (!details.write(entry.id, entry.toDetailRecord())) {
+        return false;
+    }
+    // A night with no summary entry at all gets one from the file
+    return known || m_store->upsert(entry.toVariantMap());
+}
+
+void LegacyMigration::finish() {
+    int migrated = m_migrated;
+    // Files that could not be read are left alone; running again on every
+    // login would not read them either
+    writeManifest(m_directory, migrated, m_scan.unreadable);
+    m_running = false;
+    m_scan = Scan();
+    m_detailless.clear();
+    m_migrated = 0;
+    emit finished(migrated);
+}
+
+bool LegacyMigration::writeManifest(const QString& directory, int migrated, int unreadable) {
+    QSaveFile file(manifestFileFor(directory));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << ManifestMagic << Version << qint32(migrated) << qint32(unreadable)
+        << QDateTime::currentDateTimeUtc();
+    return out.status() == QDataStream::Ok && file.commit();
+}
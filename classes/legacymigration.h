@@ -0,0 +1,79 @@
+//created by drmrsthemonarch with ai effort
+#ifndef LEGACYMIGRATION_H
+#define LEGACYMIGRATION_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "sessionkey.h"
+#include "sleepentry.h"
+
+class EntryStore;
+
+// One-shot conversion of the loose files older versions left in the data
+// directory: date-named sleep_yyyy-MM-dd.dat records from the first format
+// and sleep_<uuid>.dat records from before the pack. Runs once after login;
+// files are decrypted on the thread pool, then moved into the pack and the
+// summary journal on the GUI thread in small synced batches. A file is
+// removed only once its replacement is on disk, so an interrupted run picks
+// up where it stopped. Completion is recorded in migration.manifest, and
+// nothing else ever has to look for the old formats.
+class LegacyMigration : public QObject {
+    Q_OBJECT
+
+public:
+    // Bumped when a new conversion is added; older manifests run it again
+    static const quint32 Version = 1;
+
+    explicit LegacyMigration(EntryStore* store, QObject* parent = nullptr);
+
+    // Call once the entry store is open; does nothing if the manifest in
+    // directory is already at Version
+    void start(const QString& directory, const SessionKey& key);
+    // Stops between batches; files not moved yet stay for the next run
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    static QString manifestFileFor(const QString& directory);
+    static bool isComplete(const QString& directory);
+
+signals:
+    // Emitted after a complete run, with the number of records moved
+    void finished(int migrated);
+
+private:
+    struct LegacyFile {
+        QString path;
+        // Null for a date-named file; matched to a summary entry when applied
+        QUuid id;
+        QByteArray data;
+    };
+
+    struct Scan {
+        QVector<LegacyFile> files;
+        // Left in place: wrong key or damaged, retrying would not help
+        int unreadable = 0;
+        bool upToDate = false;
+    };
+
+    // Pure file work, safe to run on any thread
+    static Scan scan(const QString& directory, const SessionKey& key);
+    static bool writeManifest(const QString& directory, int migrated, int unreadable);
+
+    void applyBatch(quint64 generation, int first);
+    bool applyFile(const LegacyFile& file);
+    void finish();
+
+    EntryStore* m_store;
+    QString m_directory;
+    Scan m_scan;
+    // Summary entries without a detail record, by night, for date-named files
+    QHash<qint64, QUuid> m_detailless;
+    int m_migrated;
+    bool m_running;
+    quint64 m_generation;
+};
+
+#endif // LEGACYMIGRATION_H
@@ -0,0 +1,266 @@
+//created by drmrsthemonarch with ai effort
+#include "linearregression.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+// Rows per block; a block of every predictor stays in L2 while all their
+// cross products are accumulated from it
+const int RowBlock = 256;
+
+// A predictor whose spread is below this, relative to its largest value,
+// is constant up to rounding
+const double ConstantTolerance = 1e-12;
+
+// A Cholesky pivot below this, relative to the largest diagonal entry,
+// means the predictors are collinear
+const double PivotTolerance = 1e-10;
+
+// Two-sided 95% critical values of Student's t for 1 to 10 degrees of
+// freedom, where the expansion below is too far off (24% low at one)
+const double SmallTCritical[] = {12.706204736174707, 4.302652729749464, 3.182446305284263,
+                                 2.776445105197799,  2.570581835636314, 2.446911851144969,
+                                 2.364624251592784,  2.306004135204166, 2.262157162798205,
+                                 2.228138851964938};
+
+// Two-sided 95% critical value of Student's t: exact up to 10 degrees of
+// freedom, then a Cornish-Fisher expansion about the normal, within 0.01%
+double tCritical(int degreesOfFreedom) {
+    if (degreesOfFreedom <= 10) {
+        return SmallTCritical[qMax(1, degreesOfFreedom) - 1];
+    }
+    const double z = 1.959963984540054;
+    double df = degreesOfFreedom;
+    double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z;
+    return z + (z3 + z) / (4.0 * df) + (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df)
+           + (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / (384.0 * df * df * df);
+}
+
+// Lower-triangular L with L L^T = a (k x k, row-major), in place; false if
+// a is not positive definite
+bool cholesky(QVector<double>& a, int k) {
+    double largest = 0.0;
+    for (int i = 0; i < k; ++i) {
+        largest = qMax(largest, a[i * k + i]);
+    }
+    for (int j = 0; j < k; ++j) {
+        double pivot = a[j * k + j];
+        for (int m = 0; m < j; ++m) {
+            pivot -= a[j * k + m] * a[j * k + m];
+        }
+        if (!(pivot > PivotTolerance * largest)) {
+            return false;
+        }
+        pivot = std::sqrt(pivot);
+        a[j * k + j] = pivot;
+        for (int i = j + 1; i < k; ++i) {
+            double value = a[i * k + j];
+            for (int m = 0; m < j; ++m) {
+                value -= a[i * k + m] * a[j * k + m];
+            }
+            a[i * k + j] = value / pivot;
+        }
+    }
+    return true;
+}
+
+// Solves L L^T x = b in place
+void solve(const QVector<double>& l, int k, double* b) {
+    for (int i = 0; i < k; ++i) {
+        double value = b[i];
+        for (int m = 0; m < i; ++m) {
+            value -= l[i * k + m] * b[m];
+        }
+        b[i] = value / l[i * k + i];
+    }
+    for (int i = k - 1; i >= 0; --i) {
+        double value = b[i];
+        for (int m = i + 1; m < k; ++m) {
+            value -= l[m * k + i] * b[m];
+        }
+        b[i] = value / l[i * k + i];
+    }
+}
+}
+
+LinearRegression::Result LinearRegression::fit(const QVector<const double*>& predictors,
+                                               const double* response, int rows, double ridge) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const int p = predictors.size();
+
+    Result result;
+    result.observations = rows;
+    result.ridge = ridge;
+    result.coefficients.fill(nan, p);
+    result.standardErrors.fill(nan, p);
+    result.lower.fill(nan, p);
+    result.upper.fill(nan, p);
+    result.standardized.fill(nan, p);
+    if (rows < 3 || !response) {
+        result.error = "Not enough entries to fit.";
+        return result;
+    }
+
+    // Means and spreads; constant predictors are left out of the fit
+    QVector<int> active;
+    QVector<double> means, scales;
+    for (int j = 0; j < p; ++j) {
+        const double* x = predictors[j];
+        if (!x) {
+            continue;
+        }
+        double sum = 0.0, largest = 0.0;
+        for (int r = 0; r < rows; ++r) {
+            sum += x[r];
+            largest = qMax(largest, std::fabs(x[r]));
+        }
+        double mean = sum / rows;
+        double squares = 0.0;
+        for (int r = 0; r < rows; ++r) {
+            squares += (x[r] - mean) * (x[r] - mean);
+        }
+        double floor = largest * ConstantTolerance;
+        if (squares > rows * floor * floor) {
+            active.append(j);
+            means.append(mean);
+            scales.append(std::sqrt(squares / (rows - 1)));
+        }
+    }
+    const int k = active.size();
+    const int degreesOfFreedom = rows - k - 1;
+    if (k == 0) {
+        result.error = "None of the symptoms change over these entries.";
+        return result;
+    }
+    if (degreesOfFreedom < 1) {
+        result.error = "There must be more entries than symptoms.";
+        return result;
+    }
+
+    double meanY = 0.0;
+    for (int r = 0; r < rows; ++r) {
+        meanY += response[r];
+    }
+    meanY /= rows;
+
+    // Gram matrix, cross products with the response and its spread, one
+    // block of standardized rows at a time
+    QVector<double> gram(k * k, 0.0);
+    QVector<double> crossY(k, 0.0);
+    QVector<double> block(k * RowBlock);
+    double totalSquares = 0.0;
+    for (int first = 0; first < rows; first += RowBlock) {
+        const int length = qMin(RowBlock, rows - first);
+        for (int a = 0; a < k; ++a) {
+            const double* x = predictors[active[a]] + first;
+            double* z = block.data() + a * RowBlock;
+            double scale = 1.0 / scales[a];
+            for (int r = 0; r < length; ++r) {
+                z[r] = (x[r] - means[a]) * scale;
+            }
+        }
+        const double* y = response + first;
+        for (int r = 0; r < length; ++r) {
+            totalSquares += (y[r] - meanY) * (y[r] - meanY);
+        }
+        for (int a = 0; a < k; ++a) {
+            const double* za = block.constData() + a * RowBlock;
+            double sumY = 0.0;
+            for (int r = 0; r < length; ++r) {
+                sumY += za[r] * (y[r] - meanY);
+            }
+            crossY[a] += sumY;
+            for (int b = a; b < k; ++b) {
+                const double* zb = block.constData() + b * RowBlock;
+                double sum = 0.0;
+                for (int r = 0; r < length; ++r) {
+                    sum += za[r] * zb[r];
+                }
+                gram[a * k + b] += sum;
+            }
+        }
+    }
+    for (int a = 0; a < k; ++a) {
+        for (int b = 0; b < a; ++b) {
+            gram[a * k + b] = gram[b * k + a];
+        }
+    }
+
+    // Every standardized predictor has squares summing to rows - 1
+    QVector<double> factor = gram;
+    for (int a = 0; a < k; ++a) {
+        factor[a * k + a] += ridge * (rows - 1);
+    }
+    if (!cholesky(factor, k)) {
+        result.error = "Some symptoms move together too closely to separate; "
+                       "add a ridge penalty or select fewer symptoms.";
+        return result;
+    }
+    QVector<double> beta = crossY;
+    solve(factor, k, beta.data());
+
+    // Residuals from the sums already gathered, without another pass
+    double fitted = 0.0, explained = 0.0;
+    for (int a = 0; a < k; ++a) {
+        double row = 0.0;
+        for (int b = 0; b < k; ++b) {
+            row += gram[a * k + b] * beta[b];
+        }
+        fitted += beta[a] * row;
+        explained += beta[a] * crossY[a];
+    }
+    double residualSquares = qMax(0.0, totalSquares - 2.0 * explained + fitted);
+    double variance = residualSquares / degreesOfFreedom;
+
+    // Covariance of the estimates: variance * A^-1 G A^-1, where A is the
+    // penalized Gram matrix; without a penalty that is variance * G^-1
+    QVector<double> inverse(k * k, 0.0);
+    for (int a = 0; a < k; ++a) {
+        double* column = inverse.data() + a * k;
+        column[a] = 1.0;
+        solve(factor, k, column);
+    }
+    QVector<double> covariance = inverse;
+    if (ridge > 0.0) {
+        QVector<double> product(k * k, 0.0);
+        for (int a = 0; a < k; ++a) {
+            for (int b = 0; b < k; ++b) {
+                double sum = 0.0;
+                for (int m = 0; m < k; ++m) {
+                    sum += gram[a * k + m] * inverse[m * k + b];
+                }
+                product[a * k + b] = sum;
+            }
+        }
+        for (int a = 0; a < k; ++a) {
+            for (int b = 0; b < k; ++b) {
+                double sum = 0.0;
+                for (int m = 0; m < k; ++m) {
+                    sum += inverse[a * k + m] * product[m * k + b];
+                }
+                covariance[a * k + b] = sum;
+            }
+        }
+    }
+
+    double spreadY = totalSquares > 0.0 ? std::sqrt(totalSquares / (rows - 1)) : 0.0;
+    double t = tCritical(degreesOfFreedom);
+    result.intercept = meanY;
+    for (int a = 0; a < k; ++a) {
+        int j = active[a];
+        double coefficient = beta[a] / scales[a];
+        double error = std::sqrt(qMax(0.0, variance * covariance[a * k + a])) / scales[a];
+        result.coefficients[j] = coefficient;
+        result.standardErrors[j] = error;
+        result.lower[j] = coefficient - t * error;
+        result.upper[j] = coefficient + t * error;
+        result.standardized[j] = spreadY > 0.0 ? beta[a] / spreadY : nan;
+        result.intercept -= coefficient * means[a];
+    }
+
+    result.rSquared = totalSquares > 0.0 ? 1.0 - residualSquares / totalSquares : nan;
+    result.adjustedRSquared = 1.0 - (1.0 - result.rSquared) * (rows - 1) / degreesOfFreedom;
+    result.residualStandardError = std::sqrt(variance);
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,42 @@
+//created by drmrsthemonarch with ai effort
+#ifndef LINEARREGRESSION_H
+#define LINEARREGRESSION_H
+
+#include <QString>
+#include <QVector>
+
+// Least-squares fit of one series on several others, with an optional
+// ridge penalty. Predictors are centred and scaled to unit variance; their
+// Gram matrix is accumulated over cache-sized blocks of rows and solved by
+// Cholesky, so a fit costs one pass over the rows plus work in the number
+// of predictors only.
+class LinearRegression {
+public:
+    struct Result {
+        bool ok = false;
+        QString error;
+        int observations = 0;
+        double ridge = 0.0;
+        double intercept = 0.0;
+        // Per predictor, in input order, in units of the response per unit
+        // of the predictor; NaN for a predictor that never changes
+        QVector<double> coefficients;
+        QVector<double> standardErrors;
+        // 95% confidence interval
+        QVector<double> lower;
+        QVector<double> upper;
+        // Change in the response, in its standard deviations, per standard
+        // deviation of the predictor; comparable across predictors
+        QVector<double> standardized;
+        double rSquared = 0.0;
+        double adjustedRSquared = 0.0;
+        double residualStandardError = 0.0;
+    };
+
+    // A null predictor reads as all zeros. ridge is the penalty as a
+    // fraction of each predictor's variance; 0 is ordinary least squares.
+    static Result fit(const QVector<const double*>& predictors, const double* response, int rows,
+                      double ridge = 0.0);
+};
+
+#endif // LINEARREGRESSION_H
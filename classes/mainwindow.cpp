@@ -1,26 +1,154 @@
 // created by drmrsthemonarch with ai effort
 #include "mainwindow.h"
+#include "correlationmatrix.h"
+#include "csvimporter.h"
 #include "datapathmanager.h"
 #include "histogramwidget.h"
+#include "laggedcorrelation.h"
+#include "legacymigration.h"
+#include "linearregression.h"
 #include "logindialog.h"
+#include "storagesync.h"
 #include "wordcloudwidget.h"
+#include <QApplication>
 #include <QDataStream>
+#include <QDialogButtonBox>
+#include <QFileDialog>
 #include <QToolBar>
+#include <algorithm>
+
+// Column backing a symptom/metric list item, or nullptr if the table has none
+static const double *seriesFor(const SleepTableView &table,
+                               const QString &name) {
+  if (name == "Sleep Duration") {
+    return table.sleepDuration();
+  }
+  int column = table.columnIndex(name);
+  return column >= 0 ? table.column(column) : nullptr;
+}
+
+// Table column name of a symptom/metric list item
+static QString tableColumnFor(const QString &name) {
+  return name == "Sleep Duration" ? QString("sleep_duration") : name;
+}
+
+// Rollup level that leaves each bucket at least four pixels along an axis.
+// A fresh axis rect has no size until its first replot, so the widget's
+// width stands in for it.
+static RollupPyramid::Level rollupLevelFor(QCPAxis *axis) {
+  int pixels = axis->axisRect()->width();
+  if (pixels <= 0) {
+    pixels = axis->parentPlot()->width();
+  }
+  return RollupPyramid::levelFor(axis->range().size() / 86400.0,
+                                 qMax(1, pixels / 4));
+}
+
+static QString dateFormatFor(RollupPyramid::Level level) {
+  return level <= RollupPyramid::Week ? "MMM d\nyyyy" : "MMM yyyy";
+}
+
+// One value per night: symptom values of entries sharing a date are summed,
+// sleep duration is taken from the last entry saved for that date
+static void aggregateByNight(const SleepTableView &table,
+                             const QStringList &selectedSymptoms,
+                             QVector<double> &dateNumbers,
+                             QVector<QVector<double>> &values) {
+  QVector<const double *> series;
+  for (const QString &name : selectedSymptoms) {
+    series.append(seriesFor(table, name));
+  }
+
+  dateNumbers.clear();
+  values = QVector<QVector<double>>(selectedSymptoms.size());
+
+  const qint64 *days = table.days();
+  const int rows = table.rowCount();
+
+  // Rows are sorted by date, so entries of one night are adjacent
+  for (int first = 0; first < rows;) {
+    int last = first + 1;
+    while (last < rows && days[last] == days[first]) {
+      ++last;
+    }
+
+    dateNumbers.append(
+        QDateTime(QDate::fromJulianDay(days[first])).toMSecsSinceEpoch() /
+        1000.0);
+
+    for (int i = 0; i < series.size(); ++i) {
+      double value = 0.0;
+      if (!series[i]) {
+        // Not a column of this table
+      } else if (selectedSymptoms[i] == "Sleep Duration") {
+        value = series[i][last - 1];
+      } else {
+        for (int row = first; row < last; ++row) {
+          value += series[i][row];
+        }
+      }
+      values[i].append(value);
+    }
+
+    first = last;
+  }
+}
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
+  // Entry changes arriving together redraw the visible tab once, without
+  // the dialogs a user-requested load shows
+  visibleTabRefresh = new QTimer(this);
+  visibleTabRefresh->setSingleShot(true);
+  visibleTabRefresh->setInterval(0);
+  connect(visibleTabRefresh, &QTimer::timeout, this,
+          [this]() { refreshTab(tabWidget->currentIndex(), false); });
+
+  // Summary history shared by all tabs; changes refresh them from memory
+  entryStore = new EntryStore(this);
+  connect(entryStore, &EntryStore::entriesReset, this,
+          &MainWindow::onEntriesChanged);
+  connect(entryStore, &EntryStore::entryAdded, this,
+          &MainWindow::onEntriesChanged);
+  connect(entryStore, &EntryStore::entryChanged, this,
+          &MainWindow::onEntriesChanged);
+  connect(entryStore, &EntryStore::entryRemoved, this,
+          &MainWindow::onEntriesChanged);
+
+  // Files from older versions are converted once, after the store opens
+  legacyMigration = new LegacyMigration(entryStore, this);
+  connect(entryStore, &EntryStore::opened, this, [this](bool ok) {
+    if (ok && UserManager::instance().isLoggedIn()) {
+      legacyMigration->start(
+          getCurrentDataDirectory(),
+          UserManager::instance().getCurrentUser()->getSessionKey());
+    }
+  });
+  connect(legacyMigration, &LegacyMigration::finished, this,
+          [this](int migrated) {
+            if (migrated > 0) {
+              onEntriesChanged();
+            }
+          });
+
+  // Word cloud notes are read off the GUI thread
+  wordCloudLoader = new DetailLoader(this);
+  connect(wordCloudLoader, &DetailLoader::entriesLoaded, this,
+          &MainWindow::onWordCloudEntriesLoaded);
+  connect(wordCloudLoader, &DetailLoader::finished, this,
+          &MainWindow::onWordCloudLoadFinished);
+  connect(wordCloudLoader, &DetailLoader::cancelled, this,
+          [this]() { staleTabs.insert(wordCloudTab); });
+
   setupUI();
   createUserToolbar();
 
   if (UserManager::instance().isLoggedIn()) {
     loadSymptoms();
     rebuildSymptomWidgets();
+    openEntryStore();
   }
 
   updateWindowTitle();
-
-  // Connect immediately, not with a singleShot
-  connect(tabWidget, &QTabWidget::currentChanged, this,
-          &MainWindow::onTabChanged);
 }
 
 MainWindow::~MainWindow() {
@@ -32,21 +160,6 @@ MainWindow::~MainWindow() {
 bool MainWindow::createSummaryEntry(
     const QUuid &entryId, const QDate &date, double duration,
     const QList<QPair<QString, double>> &symptomData) {
-  QString symptomFile = getSymptomDataFile();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  // Load existing summary entries
-  QList<QVariantMap> entries;
-  QByteArray existingData =
-      DataEncryption::loadEncrypted(symptomFile, password);
-
-  if (!existingData.isEmpty()) {
-    QDataStream in(&existingData, QIODevice::ReadOnly);
-    in.setVersion(QDataStream::Qt_5_15);
-    in >> entries;
-  }
-
   // Create new entry
   QVariantMap entry;
   entry["id"] = entryId.toString(QUuid::WithoutBraces);
@@ -58,16 +171,8 @@ bool MainWindow::createSummaryEntry(
     entry[pair.first] = pair.second;
   }
 
-  // Add to entries
-  entries.append(entry);
-
-  // Save updated entries back to summary file
-  QByteArray data;
-  QDataStream out(&data, QIODevice::WriteOnly);
-  out.setVersion(QDataStream::Qt_5_15);
-  out << entries;
-
-  return DataEncryption::saveEncrypted(symptomFile, data, password);
+  // Appended to the journal instead of rewriting the whole summary file
+  return entryStore->upsert(entry);
 }
 
 void MainWindow::createUserToolbar() {
@@ -82,6 +187,12 @@ void MainWindow::createUserToolbar() {
 
   userToolbar->addSeparator();
 
+  // Checks the summary against the detail records, and repairs it
+  reindexButton = new QPushButton("Rebuild Index");
+  reindexButton->setStyleSheet("padding: 5px 15px;");
+  connect(reindexButton, &QPushButton::clicked, this, &MainWindow::onReindex);
+  userToolbar->addWidget(reindexButton);
+
   // Logout button
   logoutButton = new QPushButton("Logout");
   logoutButton->setStyleSheet("padding: 5px 15px;");
@@ -98,7 +209,14 @@ void MainWindow::createUserToolbar() {
 }
 
 void MainWindow::exportHistoryToCSV(const QString &filename,
-                                    const QList<QVariantMap> &entries) {
+                                    const SleepTableView &table,
+                                    const CsvExporter::Options &options) {
+  if (table.isEmpty()) {
+    QMessageBox::warning(this, tr("Export Warning"),
+                         tr("No summary data found to export"));
+    return;
+  }
+
   QFile file(filename);
   if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
     QMessageBox::warning(
@@ -107,86 +225,25 @@ void MainWindow::exportHistoryToCSV(const QString &filename,
     return;
   }
 
-  QTextStream out(&file);
-  out.setCodec("UTF-8");
-
-  // Load data from summary file instead of individual entries
-  QList<QVariantMap> summaryData = loadSummaryData();
+  // Rows are formatted straight from the table's columns into a fixed
+  // buffer, so a long history costs no more memory than a short one
+  bool written = CsvExporter::write(file, table, options);
+  file.close();
 
-  if (summaryData.isEmpty()) {
-    QMessageBox::warning(this, tr("Export Warning"),
-                         tr("No summary data found to export"));
-    file.close();
+  if (!written) {
+    QMessageBox::warning(this, tr("Export Error"),
+                         tr("Could not write to file: %1").arg(filename));
     return;
   }
 
-  // Get all unique field names from summary data
-  QSet<QString> allFieldNames;
-  for (const auto &entry : summaryData) {
-    for (auto it = entry.begin(); it != entry.end(); ++it) {
-      allFieldNames.insert(it.key());
-    }
-  }
-
-  QStringList fieldNames = allFieldNames.toList();
-  fieldNames.sort();
-
-  // Ensure date comes first if present
-  if (fieldNames.contains("date")) {
-    fieldNames.removeAll("date");
-    fieldNames.prepend("date");
-  }
-
-  // Write CSV header
-  QStringList headers;
-  for (const QString &field : fieldNames) {
-    QString header = field;
-    header = header.replace("_", " ");
-    header[0] = header[0].toUpper();
-    headers << header;
-  }
-
-  out << headers.join(",") << "\n";
-
-  // Write data rows
-  for (const auto &entry : summaryData) {
-    QStringList row;
-
-    for (const QString &field : fieldNames) {
-      QString value;
-
-      if (entry.contains(field)) {
-        QVariant fieldValue = entry.value(field);
-        if (fieldValue.type() == QVariant::Date) {
-          value = fieldValue.toDate().toString("yyyy-MM-dd");
-        } else if (fieldValue.type() == QVariant::DateTime) {
-          value = fieldValue.toDateTime().toString("yyyy-MM-dd hh:mm:ss");
-        } else if (fieldValue.type() == QVariant::Time) {
-          value = fieldValue.toTime().toString("hh:mm:ss");
-        } else {
-          value = fieldValue.toString();
-        }
-      }
-
-      // Escape commas and quotes in CSV values
-      if (value.contains(",") || value.contains("\"")) {
-        value = "\"" + value.replace("\"", "\"\"") + "\"";
-      }
-
-      row << (value.isEmpty() ? "0" : value);
-    }
-
-    out << row.join(",") << "\n";
-  }
-
-  file.close();
-
+  int fields = 1 + int(options.includeId) + int(options.includeDuration) +
+               options.symptoms.size();
   QMessageBox::information(this, tr("Export Complete"),
                            tr("History exported successfully to:\n%1\n\n%2 "
                               "entries exported with %3 fields")
                                .arg(filename)
-                               .arg(summaryData.size())
-                               .arg(fieldNames.size()));
+                               .arg(table.rowCount())
+                               .arg(fields));
 }
 
 void MainWindow::initializeHistogram() const {
@@ -219,20 +276,7 @@ QString MainWindow::getSymptomDataFile() {
   return QString("%1/symptom_history.dat").arg(dataDir);
 }
 
-QList<QVariantMap>
-MainWindow::filterEntriesByDateRange(const QList<QVariantMap> &entries,
-                                     const QDate &start, const QDate &end) {
-  QList<QVariantMap> filtered;
-  for (const auto &entry : entries) {
-    QDate entryDate = entry["date"].toDate();
-    if (entryDate >= start && entryDate <= end) {
-      filtered.append(entry);
-    }
-  }
-  return filtered;
-}
-
-void MainWindow::loadHistogramData() {
+void MainWindow::loadHistogramData(bool userInitiated) {
   if (!UserManager::instance().isLoggedIn()) {
     return;
   }
@@ -260,189 +304,73 @@ void MainWindow::loadHistogramData() {
   }
 
   if (selectedSymptoms.isEmpty()) {
-    QMessageBox::warning(
-        this, "No Selection",
-        "Please select at least one symptom or metric to plot.");
+    if (userInitiated) {
+      QMessageBox::warning(
+          this, "No Selection",
+          "Please select at least one symptom or metric to plot.");
+    }
     return;
   }
 
-  // Load all entries
-  QList<QVariantMap> entries = loadAllEntries();
+  // Columnar, already sorted by date
+  SleepTableView table = entryStore->table().all();
 
-  if (entries.isEmpty()) {
+  if (table.isEmpty()) {
     histogramCustomPlot->clearGraphs();
     histogramCustomPlot->clearPlottables();
     histogramCustomPlot->replot();
-    QMessageBox::information(this, "No Data",
-                             "No sleep data available for analysis.");
+    if (userInitiated) {
+      QMessageBox::information(this, "No Data",
+                               "No sleep data available for analysis.");
+    }
     return;
   }
 
   // Filter by date range if needed
   if (!histogramAllDateRangeCheckbox->isChecked()) {
-    entries = filterEntriesByDateRange(entries, histogramStartDateEdit->date(),
-                                       histogramEndDateEdit->date());
-    if (entries.isEmpty()) {
-      QMessageBox::information(this, "No Data",
-                               "No data in selected date range.");
+    table = entryStore->table().range(histogramStartDateEdit->date(),
+                                      histogramEndDateEdit->date());
+    if (table.isEmpty()) {
+      if (userInitiated) {
+        QMessageBox::information(this, "No Data",
+                                 "No data in selected date range.");
+      }
       return;
     }
   }
 
-  // Sort by date
-  std::sort(entries.begin(), entries.end(),
-            [](const QVariantMap &a, const QVariantMap &b) {
-              return a["date"].toDate() < b["date"].toDate();
-            });
-
   // Generate stacked histogram
-  plotHistogramStacked(entries, selectedSymptoms);
+  plotHistogramStacked(table, selectedSymptoms);
 }
 
-QList<QVariantMap> MainWindow::loadAllEntries() {
-  QList<QVariantMap> allEntries;
-
-  if (!UserManager::instance().isLoggedIn()) {
-    return allEntries;
-  }
-
-  QString symptomFile = getSymptomDataFile();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  QByteArray data = DataEncryption::loadEncrypted(symptomFile, password);
-
-  if (!data.isEmpty()) {
-    QDataStream in(&data, QIODevice::ReadOnly);
-    in.setVersion(QDataStream::Qt_5_15);
-    in >> allEntries;
-  }
-
-  // Check if entries have IDs, if not, add them (migration on-the-fly)
-  bool needsMigration = false;
-  for (auto &entry : allEntries) {
-    if (!entry.contains("id")) {
-      // This is an old entry without ID, generate one
-      entry["id"] = QUuid::createUuid().toString(QUuid::WithoutBraces);
-      needsMigration = true;
-    }
-  }
+void MainWindow::openEntryStore() {
+  SessionKey key = UserManager::instance().getCurrentUser()->getSessionKey();
+  entryStore->setColumnNames(symptomNames());
+  entryStore->openAsync(getSymptomDataFile(), key);
+}
 
-  // Save back if migration was needed
-  if (needsMigration) {
-    QByteArray updatedData;
-    QDataStream out(&updatedData, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_15);
-    out << allEntries;
-    DataEncryption::saveEncrypted(symptomFile, updatedData, password);
+QStringList MainWindow::symptomNames() const {
+  QStringList names;
+  for (const Symptom &s : symptoms) {
+    names << s.getName();
   }
-
-  return allEntries;
+  return names;
 }
 
-QList<QVariantMap> MainWindow::loadSummaryData() { return loadAllEntries(); }
-
 void MainWindow::loadHistoryData() {
   if (!UserManager::instance().isLoggedIn()) {
     return;
   }
 
-  historyTable->setRowCount(0);
-
-  QList<QVariantMap> entries = loadAllEntries();
-
-  // Sort by date descending
-  std::sort(entries.begin(), entries.end(),
-            [](const QVariantMap &a, const QVariantMap &b) {
-              return a["date"].toDate() > b["date"].toDate();
-            });
-
-  historyTable->setRowCount(entries.size());
-
-  for (int i = 0; i < entries.size(); ++i) {
-    const QVariantMap &entry = entries[i];
-    QString entryId = entry["id"].toString();
-    QDate entryDate = entry["date"].toDate();
-
-    // Date
-    auto *dateItem = new QTableWidgetItem(entryDate.toString("yyyy-MM-dd"));
-    dateItem->setData(Qt::UserRole, entryId); // Store ID in item data
-    historyTable->setItem(i, 0, dateItem);
-
-    // Sleep duration
-    double duration = entry["sleep_duration"].toDouble();
-    auto *durationItem =
-        new QTableWidgetItem(QString::number(duration, 'f', 1) + " hrs");
-    historyTable->setItem(i, 1, durationItem);
-
-    // Try to load detailed data using ID first, then fall back to date
-    QString dataDir = getCurrentDataDirectory();
-    QString idBasedFilename =
-        QString("%1/sleep_%2.dat").arg(dataDir).arg(entryId);
-    QString dateBasedFilename = QString("%1/sleep_%2.dat")
-                                    .arg(dataDir)
-                                    .arg(entryDate.toString("yyyy-MM-dd"));
-
-    QString bedtimeStr = "-";
-    QString waketimeStr = "-";
-
-    QString password =
-        UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-    // Try ID-based filename first (new system)
-    QByteArray dailyData =
-        DataEncryption::loadEncrypted(idBasedFilename, password);
-
-    // If not found, try date-based filename (old system)
-    if (dailyData.isEmpty()) {
-      dailyData = DataEncryption::loadEncrypted(dateBasedFilename, password);
-    }
-
-    if (!dailyData.isEmpty()) {
-      QDataStream in(&dailyData, QIODevice::ReadOnly);
-      in.setVersion(QDataStream::Qt_5_15);
-
-      QUuid id;
-      QDateTime timestamp;
-      QDate date;
-      QTime bedtime, waketime;
-
-      in >> id >> timestamp >> date >> bedtime >> waketime;
-
-      bedtimeStr = bedtime.toString("HH:mm");
-      waketimeStr = waketime.toString("HH:mm");
-
-      // If this was an old file without ID, migrate it now
-      if (id.isNull()) {
-        id = QUuid::createUuid();
-        // ... save with new ID format (similar to saveEntry logic)
-      }
-    }
-
-    historyTable->setItem(i, 2, new QTableWidgetItem(bedtimeStr));
-    historyTable->setItem(i, 3, new QTableWidgetItem(waketimeStr));
-
-    // Symptoms (your existing code)
-    QStringList symptomList;
-    for (const Symptom &s : symptoms) {
-      double value = entry.value(s.getName(), 0.0).toDouble();
-      if (value > 0) {
-        if (s.getType() == SymptomType::Binary) {
-          symptomList << s.getName();
-        } else {
-          symptomList << QString("%1 (%2)").arg(s.getName()).arg(value);
-        }
-      }
-    }
-
-    auto *symptomsItem = new QTableWidgetItem(symptomList.join(", "));
-    historyTable->setItem(i, 4, symptomsItem);
-  }
+  // Rows come from the entry store; detail records are read by the model
+  // only for the rows the view actually shows
+  historyModel->setSymptoms(symptoms);
+  historyModel->reload();
 
   historyTable->resizeColumnsToContents();
 }
 
-void MainWindow::loadStatisticsData() {
+void MainWindow::loadStatisticsData(bool userInitiated) {
   if (!UserManager::instance().isLoggedIn()) {
     return;
   }
@@ -470,58 +398,80 @@ void MainWindow::loadStatisticsData() {
   }
 
   if (selectedSymptoms.isEmpty()) {
-    QMessageBox::warning(
-        this, "No Selection",
-        "Please select at least one symptom or metric to plot.");
+    if (userInitiated) {
+      QMessageBox::warning(
+          this, "No Selection",
+          "Please select at least one symptom or metric to plot.");
+    }
     return;
   }
 
-  // Load all entries
-  QList<QVariantMap> entries = loadAllEntries();
+  // Columnar, already sorted by date
+  SleepTableView table = entryStore->table().all();
 
-  if (entries.isEmpty()) {
+  if (table.isEmpty()) {
+    resetStatisticsPlot();
+    timeSeriesGraphs.clear();
+    regressionSymptoms.clear();
     customPlot->clearGraphs();
     customPlot->clearPlottables();
     customPlot->replot();
-    QMessageBox::information(this, "No Data",
-                             "No sleep data available for analysis.");
+    if (userInitiated) {
+      QMessageBox::information(this, "No Data",
+                               "No sleep data available for analysis.");
+    }
     return;
   }
 
   // Filter by date range if needed
   if (!allDateRangeCheckbox->isChecked()) {
-    entries = filterEntriesByDateRange(entries, startDateEdit->date(),
-                                       endDateEdit->date());
-    if (entries.isEmpty()) {
-      QMessageBox::information(this, "No Data",
-                               "No data in selected date range.");
+    table = entryStore->table().range(startDateEdit->date(),
+                                      endDateEdit->date());
+    if (table.isEmpty()) {
+      if (userInitiated) {
+        QMessageBox::information(this, "No Data",
+                                 "No data in selected date range.");
+      }
       return;
     }
   }
 
-  // Sort by date
-  std::sort(entries.begin(), entries.end(),
-            [](const QVariantMap &a, const QVariantMap &b) {
-              return a["date"].toDate() < b["date"].toDate();
-            });
-
   // Plot based on selected type
+  resetStatisticsPlot();
+  timeSeriesGraphs.clear();
+  regressionSymptoms.clear();
 
   switch (int plotType = plotTypeSelector->currentIndex()) {
   case 0: // Time Series
-    plotTimeSeriesData(entries, selectedSymptoms);
+    plotTimeSeriesData(table, selectedSymptoms);
     break;
   case 1: // Histogram
-    plotHistogramData(entries, selectedSymptoms);
+    plotHistogramData(table, selectedSymptoms);
     break;
   case 2: // Correlation
     if (selectedSymptoms.size() < 2) {
-      QMessageBox::warning(
-          this, "Multiple Selection Required",
-          "Correlation view requires at least 2 symptoms selected.");
+      if (userInitiated) {
+        QMessageBox::warning(
+            this, "Multiple Selection Required",
+            "Correlation view requires at least 2 symptoms selected.");
+      }
       return;
     }
-    plotCorrelationData(entries, selectedSymptoms);
+    plotCorrelationData(table, selectedSymptoms);
+    break;
+  case 3: // Lag analysis
+    plotLaggedCorrelation(table, selectedSymptoms);
+    break;
+  case 4: // Regression
+    if (selectedSymptoms.size() == selectedSymptoms.count("Sleep Duration")) {
+      if (userInitiated) {
+        QMessageBox::warning(
+            this, "No Symptoms Selected",
+            "Regression requires at least 1 symptom besides Sleep Duration.");
+      }
+      return;
+    }
+    plotRegression(table, selectedSymptoms);
     break;
   }
 }
@@ -535,10 +485,9 @@ void MainWindow::loadSymptoms() {
 
   // Load from user-specific encrypted binary file
   QString userSymptomsFile = getCurrentDataDirectory() + "/symptoms.dat";
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
+  SessionKey key = UserManager::instance().getCurrentUser()->getSessionKey();
 
-  QByteArray data = DataEncryption::loadEncrypted(userSymptomsFile, password);
+  QByteArray data = DataEncryption::loadEncrypted(userSymptomsFile, key);
 
   if (!data.isEmpty()) {
     // Deserialize from binary
@@ -580,112 +529,100 @@ void MainWindow::loadSymptoms() {
   }
 }
 
-void MainWindow::loadWordCloudData() {
+void MainWindow::loadWordCloudData(bool userInitiated) {
   if (!UserManager::instance().isLoggedIn()) {
     return;
   }
 
-  // Load all entries
-  QList<QVariantMap> entries = loadAllEntries();
+  SleepTableView table = entryStore->table().all();
 
-  if (entries.isEmpty()) {
+  if (table.isEmpty()) {
     wordCloudWidget->setWordFrequencies(QMap<QString, int>());
     wordCountLabel->setText("Total words: 0");
-    QMessageBox::information(
-        this, "No Data", "No sleep data available for word cloud analysis.");
+    if (userInitiated) {
+      QMessageBox::information(
+          this, "No Data", "No sleep data available for word cloud analysis.");
+    }
     return;
   }
 
   // Filter by date range if needed
   if (!wordCloudAllDateRangeCheckbox->isChecked()) {
-    entries = filterEntriesByDateRange(entries, wordCloudStartDateEdit->date(),
-                                       wordCloudEndDateEdit->date());
-    if (entries.isEmpty()) {
+    table = entryStore->table().range(wordCloudStartDateEdit->date(),
+                                      wordCloudEndDateEdit->date());
+    if (table.isEmpty()) {
       wordCloudWidget->setWordFrequencies(QMap<QString, int>());
       wordCountLabel->setText("Total words: 0");
-      QMessageBox::information(this, "No Data",
-                               "No data in selected date range.");
+      if (userInitiated) {
+        QMessageBox::information(this, "No Data",
+                                 "No data in selected date range.");
+      }
       return;
     }
   }
 
-  // Extract text from all notes
-  QString allNotesText;
-  int entriesWithNotes = 0;
-
-  QString dataDir = getCurrentDataDirectory();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  for (const QVariantMap &entry : entries) {
-    // Use UUID for filename instead of date
-    QString entryId = entry["id"].toString();
-    if (entryId.isEmpty()) {
-      continue; // Skip entries without ID
-    }
-
-    QString filename = QString("%1/sleep_%2.dat")
-                           .arg(dataDir)
-                           .arg(entryId); // Use UUID instead of date
-
-    QByteArray data = DataEncryption::loadEncrypted(filename, password);
-    if (!data.isEmpty()) {
-      QDataStream in(&data, QIODevice::ReadOnly);
-      in.setVersion(QDataStream::Qt_5_15);
-
-      QUuid id;
-      QDateTime timestamp;
-      QDate date;
-      QTime bedtime, waketime;
-      double hours;
-      QString notes;
-      QList<QPair<QString, double>> symptomData;
-
-      in >> id >> timestamp >> date >> bedtime >> waketime >> hours >> notes >>
-          symptomData;
-
-      if (!notes.trimmed().isEmpty()) {
-        allNotesText += notes + " ";
-        entriesWithNotes++;
-      }
+  // Notes are read and decrypted in the background; the cloud fills in
+  // batch by batch as they arrive
+  QVector<QUuid> ids;
+  ids.reserve(table.rowCount());
+  for (int row = 0; row < table.rowCount(); ++row) {
+    if (!table.id(row).isNull()) {
+      ids.append(table.id(row));
     }
   }
 
-  if (allNotesText.trimmed().isEmpty()) {
-    wordCloudWidget->setWordFrequencies(QMap<QString, int>());
-    wordCountLabel->setText("Total words: 0");
-    return;
-  }
-
-  // Process text and count word frequencies
-  QMap<QString, int> wordFrequencies;
+  wordCloudFrequencies.clear();
+  wordCloudTotalWords = 0;
+  wordCloudEntriesWithNotes = 0;
+  wordCloudWidget->setMinimumFrequency(minWordFrequencySpinBox->value());
+  wordCloudWidget->setMaxWords(maxWordsSpinBox->value());
+  wordCloudWidget->setWordFrequencies(QMap<QString, int>());
+  wordCountLabel->setText("Loading notes...");
 
-  // Simple word extraction and cleaning
-  QStringList words =
-      allNotesText.toLower().split(QRegExp("\\W+"), QString::SkipEmptyParts);
+  wordCloudLoader->load(entryStore->details().planRead(ids));
+}
 
+void MainWindow::onWordCloudEntriesLoaded(const QVector<SleepEntry> &entries) {
   QStringList stopWords = WordCloudWidget::getStopWords();
 
-  for (const QString &word : words) {
-    // Filter out very short words and stop words
-    if (word.length() >= 3 && !stopWords.contains(word)) {
-      wordFrequencies[word]++;
+  for (const SleepEntry &entry : entries) {
+    if (entry.notes.trimmed().isEmpty()) {
+      continue;
+    }
+    wordCloudEntriesWithNotes++;
+
+    // Simple word extraction and cleaning
+    QStringList words = entry.notes.toLower().split(QRegExp("\\W+"),
+                                                    QString::SkipEmptyParts);
+    wordCloudTotalWords += words.size();
+
+    for (const QString &word : words) {
+      // Filter out very short words and stop words
+      if (word.length() >= 3 && !stopWords.contains(word)) {
+        wordCloudFrequencies[word]++;
+      }
     }
   }
 
-  // Update word cloud
-  wordCloudWidget->setMinimumFrequency(minWordFrequencySpinBox->value());
-  wordCloudWidget->setMaxWords(maxWordsSpinBox->value());
-  wordCloudWidget->setWordFrequencies(wordFrequencies);
+  wordCloudWidget->setWordFrequencies(wordCloudFrequencies);
+  wordCountLabel->setText(QString("Loading notes... %1 words so far")
+                              .arg(wordCloudTotalWords));
+}
+
+void MainWindow::onWordCloudLoadFinished() {
+  wordCloudWidget->setWordFrequencies(wordCloudFrequencies);
+
+  if (wordCloudFrequencies.isEmpty()) {
+    wordCountLabel->setText("Total words: 0");
+    return;
+  }
 
   // Update statistics
-  int totalUniqueWords = wordFrequencies.size();
-  int totalWords = words.size();
   wordCountLabel->setText(
       QString("Total unique words: %1 (from %2 total words in %3 entries)")
-          .arg(totalUniqueWords)
-          .arg(totalWords)
-          .arg(entriesWithNotes));
+          .arg(wordCloudFrequencies.size())
+          .arg(wordCloudTotalWords)
+          .arg(wordCloudEntriesWithNotes));
 }
 
 void MainWindow::onHistogramSelectAllSymptoms() {
@@ -707,9 +644,11 @@ void MainWindow::onUserChanged() {
                               ? user->getUsername()
                               : user->getDisplayName();
     userLabel->setText(QString("User: %1").arg(displayText));
+    reindexButton->setEnabled(true);
     logoutButton->setEnabled(true);
   } else {
     userLabel->setText("Not logged in");
+    reindexButton->setEnabled(false);
     logoutButton->setEnabled(false);
   }
 
@@ -728,6 +667,9 @@ void MainWindow::onLogout() {
     }
 
     UserManager::instance().logout();
+    wordCloudLoader->cancel();
+    legacyMigration->cancel();
+    entryStore->close();
 
     // Show login dialog again
     LoginDialog loginDialog(this);
@@ -735,6 +677,7 @@ void MainWindow::onLogout() {
       // User logged in successfully, reload data
       loadSymptoms();
       rebuildSymptomWidgets();
+      openEntryStore();
       onClearForm();
       updateWindowTitle();
     } else {
@@ -744,106 +687,124 @@ void MainWindow::onLogout() {
   }
 }
 
-void MainWindow::onTabChanged(int index) {
+void MainWindow::onReindex() {
+  if (!entryStore->isOpen() || legacyMigration->isRunning()) {
+    QMessageBox::information(this, "Rebuild Index",
+                             "Your data is still being loaded. Please try "
+                             "again in a moment.");
+    return;
+  }
+
+  // Reads every detail record once, decrypting across all cores
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  Reindex::Report report = entryStore->reindex(false);
+  QApplication::restoreOverrideCursor();
+
+  if (!report.ok) {
+    QMessageBox::warning(this, "Rebuild Index", report.toString());
+    return;
+  }
+  if (report.missing == 0 && report.mismatched == 0) {
+    QMessageBox::information(
+        this, "Rebuild Index",
+        "The summary matches the detail records.\n\n" + report.toString());
+    return;
+  }
+
+  QMessageBox::StandardButton reply = QMessageBox::question(
+      this, "Rebuild Index",
+      "The summary does not match the detail records.\n\n" +
+          report.toString() +
+          "\n\nRebuild the summary from the detail records?",
+      QMessageBox::Yes | QMessageBox::No);
+  if (reply != QMessageBox::Yes) {
+    return;
+  }
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  report = entryStore->reindex(true);
+  QApplication::restoreOverrideCursor();
+
+  if (report.ok) {
+    QMessageBox::information(this, "Rebuild Index",
+                             "The summary was rebuilt.\n\n" + report.toString());
+  } else {
+    QMessageBox::warning(this, "Rebuild Index",
+                         "The rebuilt summary could not be saved.");
+  }
+}
+
+void MainWindow::onEntriesChanged() {
+  // The entry store keeps the summary statistics current per change, so
+  // the panel beside the plots only reformats them
+  if (!entryStore->isLoading()) {
+    refreshStatisticsSummary();
+  }
+
+  // Every data tab is out of date; the visible one redraws once the
+  // current burst of changes is over, as an import or migration sends one
+  // change per entry
+  staleTabs = {historyTab, statisticsTab, histogramTab, wordCloudTab};
+  visibleTabRefresh->start();
+}
+
+void MainWindow::onTabChanged(int index) { refreshTab(index, true); }
+
+void MainWindow::refreshTab(int index, bool userInitiated) {
+  // Leaving the word cloud mid-load stops reading notes; it reloads on return
+  if (tabWidget->widget(index) != wordCloudTab && wordCloudLoader->isRunning()) {
+    wordCloudLoader->cancel();
+  }
+
+  // Nothing to show until the entry store has finished loading; the tab
+  // stays stale and is filled in when entriesReset arrives
+  if (entryStore->isLoading()) {
+    return;
+  }
+
+  // Switching back to an up-to-date tab keeps what it already shows
+  if (!staleTabs.remove(tabWidget->widget(index))) {
+    return;
+  }
+
   if (index == 1) {
     // History tab
     loadHistoryData();
   } else if (index == 2) {
     // Statistics tab
-    loadStatisticsData();
+    loadStatisticsData(userInitiated);
   } else if (index == 3) {
     // Histograms tab
-    loadHistogramData();
+    loadHistogramData(userInitiated);
   } else if (index == 4) {
     // Word Cloud tab
-    loadWordCloudData();
+    loadWordCloudData(userInitiated);
   }
 }
 
 void MainWindow::onHistoryDateSelected(int row, int column) {
   Q_UNUSED(column);
 
-  QTableWidgetItem *dateItem = historyTable->item(row, 0);
-  if (!dateItem)
+  QModelIndex dateIndex = historyModel->index(row, HistoryModel::DateColumn);
+  if (!dateIndex.isValid())
     return;
 
   // Try to get the entry ID from UserRole (new system)
-  QString entryId = dateItem->data(Qt::UserRole).toString();
-  QDate entryDate = QDate::fromString(dateItem->text(), "yyyy-MM-dd");
-
-  QString dataDir = getCurrentDataDirectory();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
+  QString entryId = dateIndex.data(Qt::UserRole).toString();
 
   QByteArray data;
-  QUuid id;
-  QDateTime timestamp;
-  QDate date;
-  QTime bedtime, waketime;
-  double hours;
-  QString notes;
-  QList<QPair<QString, double>> symptomData;
-
   if (!entryId.isEmpty()) {
-    // New system: Load by ID
-    QString filename = QString("%1/sleep_%2.dat").arg(dataDir).arg(entryId);
-    data = DataEncryption::loadEncrypted(filename, password);
-
-    if (!data.isEmpty()) {
-      QDataStream in(&data, QIODevice::ReadOnly);
-      in.setVersion(QDataStream::Qt_5_15);
-      in >> id >> timestamp >> date >> bedtime >> waketime >> hours >> notes >>
-          symptomData;
-    }
+    data = entryStore->details().read(QUuid::fromString(entryId));
   }
 
-  // If not found with new system, try old system (date-based)
-  if (data.isEmpty()) {
-    QString oldFilename = QString("%1/sleep_%2.dat")
-                              .arg(dataDir)
-                              .arg(entryDate.toString("yyyy-MM-dd"));
-    data = DataEncryption::loadEncrypted(oldFilename, password);
-    QByteArray oldData = DataEncryption::loadEncrypted(oldFilename, password);
-    // If we found an old entry, migrate it to the new system
-    if (!oldData.isEmpty()) {
-      // Read old data
-      QDataStream oldIn(&oldData, QIODevice::ReadOnly);
-      oldIn.setVersion(QDataStream::Qt_5_15);
-      oldIn >> timestamp >> date >> bedtime >> waketime >> hours >> notes >>
-          symptomData;
-
-      // Generate new ID for migration
-      id = QUuid::createUuid();
-      QString newFilename = QString("%1/sleep_%2.dat")
-                                .arg(dataDir)
-                                .arg(id.toString(QUuid::WithoutBraces));
-
-      // Write with ID to new file
-      QByteArray newData;
-      QDataStream newOut(&newData, QIODevice::WriteOnly);
-      newOut.setVersion(QDataStream::Qt_5_15);
-      newOut << id << timestamp << date << bedtime << waketime << hours << notes
-             << symptomData;
-
-      // Save new file
-      if (DataEncryption::saveEncrypted(newFilename, newData, password)) {
-        // Update the table to store the new ID
-        dateItem->setData(Qt::UserRole, id.toString(QUuid::WithoutBraces));
-
-        // Also update the summary file - CREATE the entry if it doesn't exist
-        if (!updateSummaryEntry(id, date, hours, symptomData)) {
-          // If update failed, create new summary entry
-          createSummaryEntry(id, date, hours, symptomData);
-        }
-
-        // Optionally remove the old file after successful migration
-        QFile::remove(oldFilename);
-
-        // Use the new data for the dialog
-        data = newData;
-        entryId = id.toString(QUuid::WithoutBraces);
-      }
-    }
+  // Files from older versions are only readable once the migration that
+  // runs after login has moved them into the pack
+  if (data.isEmpty() && legacyMigration->isRunning()) {
+    QMessageBox::information(
+        this, "Converting Data",
+        "Entries from an older version are still being converted. Please try "
+        "again in a moment.");
+    return;
   }
 
   if (!data.isEmpty()) {
@@ -1067,39 +1028,27 @@ void MainWindow::onHistoryDateSelected(int row, int column) {
         }
       }
 
-      // Save updated data to daily file (same filename since we use ID)
-      QString updatedFilename = QString("%1/sleep_%2.dat")
-                                    .arg(dataDir)
-                                    .arg(id.toString(QUuid::WithoutBraces));
+      // Save updated data to the pack (same record since we use ID)
       QByteArray newData;
       QDataStream out(&newData, QIODevice::WriteOnly);
       out.setVersion(QDataStream::Qt_5_15);
       out << id << timestamp << newDate << newBedtime << newWaketime << newHours
           << newNotes << newSymptomData;
 
-      bool dailyFileSaved =
-          DataEncryption::saveEncrypted(updatedFilename, newData, password);
+      // Both records are synced together when the batch commits
+      StorageBatch batch;
+      bool dailyFileSaved = entryStore->details().write(id, newData);
 
       // IMPORTANT: Also update the summary file using the ID
       bool summaryFileSaved =
           updateSummaryEntry(id, newDate, newHours, newSymptomData);
+      bool committed = batch.commit();
 
-      if (dailyFileSaved && summaryFileSaved) {
+      if (dailyFileSaved && summaryFileSaved && committed) {
         QMessageBox::information(&dialog, "Success",
                                  "Entry updated successfully!");
+        // The history table and plots refresh from the entry store
         dialog.accept();
-        // Refresh the history table and any open plots
-        loadHistoryData();
-        // If statistics tab is open, refresh it too
-        if (tabWidget->currentIndex() == 2) {
-          // Statistics tab index
-          loadStatisticsData();
-        }
-        // If histogram tab is open, refresh it too
-        if (tabWidget->currentIndex() == 3) {
-          // Histogram tab index
-          loadHistogramData();
-        }
       } else {
         QMessageBox::critical(&dialog, "Error", "Failed to save changes!");
       }
@@ -1112,19 +1061,21 @@ void MainWindow::onHistoryDateSelected(int row, int column) {
 }
 
 void MainWindow::onDeleteHistoryEntry() {
-  int currentRow = historyTable->currentRow();
+  int currentRow = historyTable->currentIndex().row();
   if (currentRow < 0) {
     QMessageBox::warning(this, "No Selection",
                          "Please select an entry to delete.");
     return;
   }
 
-  QTableWidgetItem *dateItem = historyTable->item(currentRow, 0);
-  if (!dateItem)
+  QModelIndex dateIndex =
+      historyModel->index(currentRow, HistoryModel::DateColumn);
+  if (!dateIndex.isValid())
     return;
 
-  QString entryId = dateItem->data(Qt::UserRole).toString();
-  QDate selectedDate = QDate::fromString(dateItem->text(), "yyyy-MM-dd");
+  QString entryId = dateIndex.data(Qt::UserRole).toString();
+  QDate selectedDate =
+      QDate::fromString(dateIndex.data().toString(), "yyyy-MM-dd");
 
   QMessageBox::StandardButton reply = QMessageBox::question(
       this, "Delete Entry",
@@ -1133,41 +1084,28 @@ void MainWindow::onDeleteHistoryEntry() {
       QMessageBox::Yes | QMessageBox::No);
 
   if (reply == QMessageBox::Yes) {
-    // Delete the daily file using ID
-    QString dataDir = getCurrentDataDirectory();
-    QString filename = QString("%1/sleep_%2.dat").arg(dataDir).arg(entryId);
-    QFile::remove(filename);
-
-    // Remove from summary file using ID
-    QList<QVariantMap> entries = loadAllEntries();
-    QList<QVariantMap> filteredEntries;
-    for (const auto &entry : entries) {
-      if (entry["id"].toString() != entryId) {
-        filteredEntries.append(entry);
-      }
-    }
-
-    // Save updated summary
-    QString symptomFile = getSymptomDataFile();
-    QString password =
-        UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-    QByteArray data;
-    QDataStream out(&data, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_15);
-    out << filteredEntries;
-
-    DataEncryption::saveEncrypted(symptomFile, data, password);
+    // Tombstone and journal record are synced as one commit
+    StorageBatch batch;
 
-    // Reload table
-    loadHistoryData();
+    // Delete the daily record using ID, then remove it from the summary;
+    // the store refreshes the table
+    bool removed = entryStore->details().remove(QUuid::fromString(entryId)) &&
+                   entryStore->remove(entryId);
+    bool committed = batch.commit();
 
-    QMessageBox::information(this, "Deleted", "Entry deleted successfully.");
+    if (removed && committed) {
+      QMessageBox::information(this, "Deleted", "Entry deleted successfully.");
+    } else {
+      QMessageBox::critical(this, "Error", "Failed to delete the entry!");
+    }
   }
 }
 
 void MainWindow::onPlotTypeChanged(int index) {
   bool isHistogram = (index == 1);
+  correlationMethodSelector->setVisible(index == 2);
+  lagRangeWidget->setVisible(index == 3);
+  ridgeWidget->setVisible(index == 4);
 }
 
 void MainWindow::onSelectAllSymptoms() {
@@ -1200,46 +1138,10 @@ void MainWindow::onSaveEntry() {
     QMessageBox::information(this, "Success",
                              "Sleep entry saved successfully!");
     onClearForm();
-    // Refresh history if on that tab
-    if (tabWidget->currentIndex() == 1) {
-      loadHistoryData();
-    }
-  }
-}
-
-QStringList MainWindow::parseCSVLine(const QString &line) {
-  QStringList values;
-  QString currentValue;
-  bool inQuotes = false;
-
-  for (int i = 0; i < line.length(); ++i) {
-    QChar ch = line[i];
-
-    if (ch == '"') {
-      if (inQuotes && i + 1 < line.length() && line[i + 1] == '"') {
-        // Escaped quote
-        currentValue += '"';
-        ++i; // Skip next quote
-      } else {
-        // Toggle quote mode
-        inQuotes = !inQuotes;
-      }
-    } else if (ch == ',' && !inQuotes) {
-      // End of field
-      values.append(currentValue.trimmed());
-      currentValue.clear();
-    } else {
-      currentValue += ch;
-    }
   }
-
-  // Add the last value
-  values.append(currentValue.trimmed());
-
-  return values;
 }
 
-void MainWindow::plotHistogramData(const QList<QVariantMap> &entries,
+void MainWindow::plotHistogramData(const SleepTableView &table,
                                    const QStringList &selectedSymptoms) {
   if (selectedSymptoms.isEmpty()) {
     return;
@@ -1249,25 +1151,26 @@ void MainWindow::plotHistogramData(const QList<QVariantMap> &entries,
 
   if (histogramMode == 0) {
     // Overlay mode
-    plotHistogramOverlay(entries, selectedSymptoms);
+    plotHistogramOverlay(table, selectedSymptoms);
   } else {
     // Stacked mode
-    plotHistogramStacked(entries, selectedSymptoms);
+    plotHistogramStacked(table, selectedSymptoms);
   }
 }
 
-void MainWindow::plotTimeSeriesData(const QList<QVariantMap> &entries,
+void MainWindow::plotTimeSeriesData(const SleepTableView &table,
                                     const QStringList &selectedSymptoms) {
   customPlot->clearGraphs();
   customPlot->clearPlottables();
+  timeSeriesGraphs.clear();
 
-  QVector<double> xData;
-  QVector<QString> dateLabels;
-
-  for (int i = 0; i < entries.size(); ++i) {
-    xData.append(i);
-    dateLabels.append(entries[i]["date"].toDate().toString("MM/dd"));
+  // Nightly, weekly, monthly and quarterly means of every selected column,
+  // built once; zooming and dragging only switch between them
+  QStringList columns;
+  for (const QString &symptomName : selectedSymptoms) {
+    columns.append(tableColumnFor(symptomName));
   }
+  timeSeriesRollup = RollupPyramid::build(table, columns);
 
   // Color palette for multiple lines
   QVector<QColor> colors = {
@@ -1284,34 +1187,29 @@ void MainWindow::plotTimeSeriesData(const QList<QVariantMap> &entries,
   int colorIndex = 0;
 
   for (const QString &symptomName : selectedSymptoms) {
-    QVector<double> yData;
-
-    for (const auto &entry : entries) {
-      if (symptomName == "Sleep Duration") {
-        yData.append(entry["sleep_duration"].toDouble());
-      } else {
-        yData.append(entry.value(symptomName, 0.0).toDouble());
-      }
-    }
-
     customPlot->addGraph();
-    customPlot->graph()->setData(xData, yData);
     customPlot->graph()->setName(symptomName);
 
     QColor color = colors[colorIndex % colors.size()];
     customPlot->graph()->setPen(QPen(color, 2));
     customPlot->graph()->setScatterStyle(
         QCPScatterStyle(QCPScatterStyle::ssCircle, color, color, 5));
+    timeSeriesGraphs.append(customPlot->graph());
 
     colorIndex++;
   }
 
-  customPlot->xAxis->setLabel("Date");
   customPlot->yAxis->setLabel("Value");
+  customPlot->xAxis->setTickLabelRotation(0);
+
+  double first = QDateTime(table.date(0)).toMSecsSinceEpoch() / 1000.0;
+  double last =
+      QDateTime(table.date(table.rowCount() - 1)).toMSecsSinceEpoch() / 1000.0;
+  double xBuffer = qMax((last - first) * 0.1, 86400.0);
+  customPlot->xAxis->setRange(first - xBuffer, last + xBuffer);
+  showTimeSeriesLevel(rollupLevelFor(customPlot->xAxis));
 
-  double xBuffer = entries.size() * 0.1;
-  customPlot->xAxis->setRange(-xBuffer, entries.size() - 1 + xBuffer);
-  customPlot->rescaleAxes();
+  customPlot->yAxis->rescale();
 
   // Add some padding to y-axis as well (10% on top)
   QCPRange yRange = customPlot->yAxis->range();
@@ -1319,14 +1217,6 @@ void MainWindow::plotTimeSeriesData(const QList<QVariantMap> &entries,
   customPlot->yAxis->setRange(yRange.lower - yPadding * 0.1,
                               yRange.upper + yPadding);
 
-  // Set custom tick labels
-  QSharedPointer<QCPAxisTickerText> textTicker(new QCPAxisTickerText);
-  for (int i = 0; i < dateLabels.size(); ++i) {
-    textTicker->addTick(i, dateLabels[i]);
-  }
-  customPlot->xAxis->setTicker(textTicker);
-  customPlot->xAxis->setTickLabelRotation(45);
-
   customPlot->legend->setVisible(true);
   customPlot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
   customPlot->axisRect()->insetLayout()->setInsetAlignment(
@@ -1337,7 +1227,41 @@ void MainWindow::plotTimeSeriesData(const QList<QVariantMap> &entries,
   customPlot->replot();
 }
 
-void MainWindow::plotHistogramOverlay(const QList<QVariantMap> &entries,
+void MainWindow::showTimeSeriesLevel(RollupPyramid::Level level) {
+  timeSeriesLevel = level;
+
+  QVector<double> keys, values;
+  for (int i = 0; i < timeSeriesGraphs.size(); ++i) {
+    if (QCPGraph *graph = timeSeriesGraphs[i]) {
+      timeSeriesRollup.series(level, i, RollupPyramid::Statistic::Mean, keys,
+                              values);
+      graph->setData(keys, values, true);
+    }
+  }
+
+  QSharedPointer<QCPAxisTickerDateTime> dateTicker(new QCPAxisTickerDateTime);
+  dateTicker->setDateTimeFormat(dateFormatFor(level));
+  customPlot->xAxis->setTicker(dateTicker);
+  customPlot->xAxis->setLabel(
+      level == RollupPyramid::Day
+          ? QString("Date")
+          : QString("Date (%1 means)").arg(RollupPyramid::levelName(level)));
+}
+
+void MainWindow::onTimeSeriesRangeChanged(const QCPRange &newRange) {
+  Q_UNUSED(newRange);
+  // Only a change of level touches the graphs; the replot that follows the
+  // zoom or drag draws them
+  if (timeSeriesGraphs.isEmpty()) {
+    return;
+  }
+  RollupPyramid::Level level = rollupLevelFor(customPlot->xAxis);
+  if (level != timeSeriesLevel) {
+    showTimeSeriesLevel(level);
+  }
+}
+
+void MainWindow::plotHistogramOverlay(const SleepTableView &table,
                                       const QStringList &selectedSymptoms) {
   for (QPointer<QCPAxis> xAxis : qAsConst(synchronizedXAxes)) {
     if (xAxis)
@@ -1364,54 +1288,23 @@ void MainWindow::plotHistogramOverlay(const QList<QVariantMap> &entries,
       QColor(244, 67, 54, 150),  QColor(0, 188, 212, 150)};
 
   // Organize data by date
-  QMap<QDate, QMap<QString, double>> dateData;
-  for (const auto &entry : entries) {
-    QDate date = QDate::fromString(entry["date"].toString(), Qt::ISODate);
-    if (!date.isValid())
-      continue;
-
-    for (const QString &symptom : selectedSymptoms)
-      dateData[date].insert(symptom, 0.0);
-
-    for (const QString &symptomName : selectedSymptoms) {
-      if (symptomName == "Sleep Duration") {
-        dateData[date][symptomName] = entry["sleep_duration"].toDouble();
-      } else if (entry.contains(symptomName)) {
-        QVariant value = entry[symptomName];
-
-        // Handle numeric, boolean, and other types
-        if (value.type() == QVariant::Bool) {
-          if (value.toBool())
-            dateData[date][symptomName] += 1.0;
-        } else if (value.canConvert(QMetaType::Double)) {
-          dateData[date][symptomName] += value.toDouble();
-        }
-      }
-    }
-  }
-
-  QList<QDate> dates = dateData.keys();
-  std::sort(dates.begin(), dates.end());
-  if (dates.isEmpty()) {
+  QVector<double> dateNumbers;
+  QVector<QVector<double>> symptomValues;
+  aggregateByNight(table, selectedSymptoms, dateNumbers, symptomValues);
+  if (dateNumbers.isEmpty()) {
     customPlot->replot();
     return;
   }
 
-  QVector<double> dateNumbers;
-  for (const QDate &date : dates)
-    dateNumbers.append(QDateTime(date).toMSecsSinceEpoch() / 1000.0);
-
   double totalSeconds = dateNumbers.last() - dateNumbers.first();
   double barWidth =
-      totalSeconds / (dates.size() * selectedSymptoms.size() * 1.5);
+      totalSeconds / (dateNumbers.size() * selectedSymptoms.size() * 1.5);
   double maxValue = 0;
 
   for (int i = 0; i < selectedSymptoms.size(); ++i) {
     const QString &symptom = selectedSymptoms[i];
-    QVector<double> values;
-    for (const QDate &date : dates) {
-      double val = dateData[date].value(symptom, 0.0);
-      values.append(val);
+    const QVector<double> &values = symptomValues[i];
+    for (double val : values) {
       maxValue = std::max(maxValue, val);
     }
 
@@ -1452,14 +1345,111 @@ void MainWindow::plotHistogramOverlay(const QList<QVariantMap> &entries,
   customPlot->replot();
 }
 
-void MainWindow::plotCorrelationData(const QList<QVariantMap> &entries,
+void MainWindow::plotCorrelationData(const SleepTableView &table,
                                      const QStringList &selectedSymptoms) {
   customPlot->clearGraphs();
   customPlot->clearPlottables();
 
-  QString baseSymptom = selectedSymptoms.first();
+  // Every pair of the selected columns at once
+  QVector<const double *> series;
+  for (const QString &name : selectedSymptoms) {
+    series.append(seriesFor(table, name));
+  }
+  bool spearman = correlationMethodSelector->currentIndex() == 1;
+  CorrelationMatrix matrix = CorrelationMatrix::compute(
+      series, table.rowCount(),
+      spearman ? CorrelationMatrix::Method::Spearman
+               : CorrelationMatrix::Method::Pearson);
+  const int size = matrix.size();
+
+  auto heatmap = new QCPColorMap(customPlot->xAxis, customPlot->yAxis);
+  heatmap->data()->setSize(size, size);
+  heatmap->data()->setRange(QCPRange(0, size - 1), QCPRange(0, size - 1));
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      heatmap->data()->setCell(i, j, matrix.at(i, j));
+    }
+  }
+
+  // Blue for negative, white for none, red for positive; grey where a
+  // column never changes and has no coefficient
+  QCPColorGradient gradient;
+  gradient.clearColorStops();
+  gradient.setColorStopAt(0.0, QColor(33, 150, 243));
+  gradient.setColorStopAt(0.5, Qt::white);
+  gradient.setColorStopAt(1.0, QColor(244, 67, 54));
+  gradient.setNanHandling(QCPColorGradient::nhNanColor);
+  gradient.setNanColor(QColor(224, 224, 224));
+  heatmap->setGradient(gradient);
+  heatmap->setInterpolate(false);
+  heatmap->setDataRange(QCPRange(-1, 1));
+
+  correlationScale = new QCPColorScale(customPlot);
+  customPlot->plotLayout()->addElement(0, 1, correlationScale);
+  correlationScale->setType(QCPAxis::atRight);
+  correlationScale->axis()->setLabel(spearman ? "Spearman rho" : "Pearson r");
+  heatmap->setColorScale(correlationScale);
+
+  correlationMarginGroup = new QCPMarginGroup(customPlot);
+  customPlot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop,
+                                         correlationMarginGroup);
+  correlationScale->setMarginGroup(QCP::msBottom | QCP::msTop,
+                                   correlationMarginGroup);
+
+  // Small matrices get their coefficients written in the cells
+  if (size <= 12) {
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        double value = matrix.at(i, j);
+        auto label = new QCPItemText(customPlot);
+        label->position->setCoords(i, j);
+        label->setText(qIsNaN(value) ? QString("-")
+                                     : QString::number(value, 'f', 2));
+        label->setColor(qAbs(value) > 0.6 ? Qt::white : Qt::black);
+      }
+    }
+  }
+
+  QSharedPointer<QCPAxisTickerText> nameTicker(new QCPAxisTickerText);
+  for (int i = 0; i < size; ++i) {
+    nameTicker->addTick(i, selectedSymptoms[i]);
+  }
+  customPlot->xAxis->setTicker(nameTicker);
+  customPlot->yAxis->setTicker(nameTicker);
+  customPlot->xAxis->setTickLabelRotation(45);
+  customPlot->xAxis->setLabel(
+      QString("%1 entries").arg(matrix.observations()));
+  customPlot->yAxis->setLabel("");
+
+  // First selected column in the top left corner
+  customPlot->xAxis->setRange(-0.5, size - 0.5);
+  customPlot->yAxis->setRange(-0.5, size - 0.5);
+  customPlot->yAxis->setRangeReversed(true);
+
+  customPlot->legend->setVisible(false);
+  customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+  customPlot->replot();
+}
+
+void MainWindow::plotLaggedCorrelation(const SleepTableView &table,
+                                       const QStringList &selectedSymptoms) {
+  customPlot->clearGraphs();
+  customPlot->clearPlottables();
+
+  int minLag = qMin(lagMinSpinBox->value(), lagMaxSpinBox->value());
+  int maxLag = qMax(lagMinSpinBox->value(), lagMaxSpinBox->value());
+
+  // Calendar-day series, so a lag of one is always the next night even
+  // across gaps; days without a value are left out, not read as zero
+  QVector<DailySeries> causes;
+  for (const QString &name : selectedSymptoms) {
+    causes.append(DailySeries::fromTable(table, tableColumnFor(name)));
+  }
+  QVector<LaggedCorrelation::Curve> curves = LaggedCorrelation::compute(
+      causes, DailySeries::fromTable(table, "sleep_duration"), minLag, maxLag);
 
   QVector<QColor> colors = {
+      QColor(33, 150, 243), // Blue
       QColor(76, 175, 80),  // Green
       QColor(255, 152, 0),  // Orange
       QColor(156, 39, 176), // Purple
@@ -1467,46 +1457,55 @@ void MainWindow::plotCorrelationData(const QList<QVariantMap> &entries,
       QColor(0, 188, 212),  // Cyan
   };
 
-  for (int i = 1; i < selectedSymptoms.size(); ++i) {
-    QString compareSymptom = selectedSymptoms[i];
-
-    QVector<double> xData, yData;
-
-    for (const auto &entry : entries) {
-      double xVal = (baseSymptom == "Sleep Duration")
-                        ? entry["sleep_duration"].toDouble()
-                        : entry.value(baseSymptom, 0.0).toDouble();
-      double yVal = (compareSymptom == "Sleep Duration")
-                        ? entry["sleep_duration"].toDouble()
-                        : entry.value(compareSymptom, 0.0).toDouble();
+  QVector<double> lags;
+  for (int lag = minLag; lag <= maxLag; ++lag) {
+    lags.append(lag);
+  }
+  QVector<int> fewestPairs(lags.size(), 0);
 
-      xData.append(xVal);
-      yData.append(yVal);
+  for (int i = 0; i < curves.size(); ++i) {
+    const LaggedCorrelation::Curve &curve = curves[i];
+    for (int l = 0; l < lags.size(); ++l) {
+      fewestPairs[l] = i == 0 ? curve.pairs[l]
+                              : qMin(fewestPairs[l], curve.pairs[l]);
     }
 
+    // Lags without enough overlapping days are NaN and leave a gap
     customPlot->addGraph();
-    customPlot->graph()->setData(xData, yData);
-    customPlot->graph()->setName(
-        QString("%1 vs %2").arg(baseSymptom).arg(compareSymptom));
-    customPlot->graph()->setLineStyle(QCPGraph::lsNone);
-
-    QColor color = colors[(i - 1) % colors.size()];
+    customPlot->graph()->setData(lags, curve.coefficients, true);
+    customPlot->graph()->setName(selectedSymptoms[i]);
+    QColor color = colors[i % colors.size()];
+    customPlot->graph()->setPen(QPen(color, 2));
     customPlot->graph()->setScatterStyle(
-        QCPScatterStyle(QCPScatterStyle::ssCircle, color, color, 7));
+        QCPScatterStyle(QCPScatterStyle::ssCircle, color, color, 5));
   }
 
-  customPlot->xAxis->setLabel(baseSymptom);
-  customPlot->yAxis->setLabel("Compared Symptoms");
-  customPlot->rescaleAxes();
-
-  // Add buffer padding (10% on all sides)
-  QCPRange xRange = customPlot->xAxis->range();
-  QCPRange yRange = customPlot->yAxis->range();
-  double xPadding = xRange.size() * 0.1;
-  double yPadding = yRange.size() * 0.1;
-
-  customPlot->xAxis->setRange(xRange.lower - xPadding, xRange.upper + xPadding);
-  customPlot->yAxis->setRange(yRange.lower - yPadding, yRange.upper + yPadding);
+  // What no correlation at all would stay within 95% of the time
+  QVector<double> upper(lags.size()), lower(lags.size());
+  for (int l = 0; l < lags.size(); ++l) {
+    double band = fewestPairs[l] > 0 ? 1.96 / qSqrt(fewestPairs[l]) : qQNaN();
+    upper[l] = band;
+    lower[l] = -band;
+  }
+  QPen bandPen(QColor(120, 120, 120), 1, Qt::DashLine);
+  customPlot->addGraph();
+  customPlot->graph()->setData(lags, upper, true);
+  customPlot->graph()->setName("95% band for no correlation");
+  customPlot->graph()->setPen(bandPen);
+  customPlot->addGraph();
+  customPlot->graph()->setData(lags, lower, true);
+  customPlot->graph()->setPen(bandPen);
+  customPlot->graph()->removeFromLegend();
+
+  QSharedPointer<QCPAxisTickerFixed> lagTicker(new QCPAxisTickerFixed);
+  lagTicker->setTickStep(1.0);
+  lagTicker->setScaleStrategy(QCPAxisTickerFixed::ssMultiples);
+  customPlot->xAxis->setTicker(lagTicker);
+  customPlot->xAxis->setTickLabelRotation(0);
+  customPlot->xAxis->setLabel("Lag k (days): symptom on day N, sleep on night N + k");
+  customPlot->yAxis->setLabel("Correlation r");
+  customPlot->xAxis->setRange(minLag - 0.5, maxLag + 0.5);
+  customPlot->yAxis->setRange(-1, 1);
 
   customPlot->legend->setVisible(true);
   customPlot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
@@ -1518,7 +1517,142 @@ void MainWindow::plotCorrelationData(const QList<QVariantMap> &entries,
   customPlot->replot();
 }
 
-void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
+void MainWindow::resetStatisticsPlot() {
+  // The heatmap's scale, and the labels, name ticks and flipped y axis of
+  // the heatmap and regression chart, would otherwise carry over into the
+  // next plot
+  customPlot->clearPlottables();
+  customPlot->clearItems();
+  if (correlationScale) {
+    customPlot->plotLayout()->remove(correlationScale);
+    customPlot->plotLayout()->simplify();
+    delete correlationMarginGroup;
+  }
+
+  customPlot->xAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+  customPlot->yAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+  customPlot->xAxis->setTickLabelRotation(0);
+  customPlot->yAxis->setRangeReversed(false);
+}
+
+void MainWindow::plotRegression(const SleepTableView &table,
+                                const QStringList &selectedSymptoms) {
+  customPlot->clearGraphs();
+  customPlot->clearPlottables();
+  customPlot->clearItems();
+  regressionSymptoms = selectedSymptoms;
+
+  // Every selected symptom at once; a symptom missing from an entry counts
+  // as zero, as in the table
+  QStringList names;
+  QVector<const double *> predictors;
+  for (const QString &name : selectedSymptoms) {
+    if (name != "Sleep Duration") {
+      names.append(name);
+      predictors.append(seriesFor(table, name));
+    }
+  }
+  LinearRegression::Result fit =
+      LinearRegression::fit(predictors, table.sleepDuration(),
+                            table.rowCount(), ridgeSpinBox->value());
+
+  // Clearest effects at the top; symptoms that never change have none
+  QVector<int> order;
+  for (int i = 0; i < names.size(); ++i) {
+    if (fit.ok && !qIsNaN(fit.coefficients[i])) {
+      order.append(i);
+    }
+  }
+  auto clarity = [&fit](int i) {
+    return fit.standardErrors[i] > 0.0
+               ? qAbs(fit.coefficients[i]) / fit.standardErrors[i]
+               : qInf();
+  };
+  std::sort(order.begin(), order.end(),
+            [&clarity](int a, int b) { return clarity(a) < clarity(b); });
+
+  // Bars lie along the y axis, one per symptom
+  auto increases = new QCPBars(customPlot->yAxis, customPlot->xAxis);
+  auto decreases = new QCPBars(customPlot->yAxis, customPlot->xAxis);
+  increases->setName("Longer sleep");
+  decreases->setName("Shorter sleep");
+  increases->setPen(QPen(QColor(76, 175, 80)));
+  increases->setBrush(QColor(76, 175, 80, 150));
+  decreases->setPen(QPen(QColor(244, 67, 54)));
+  decreases->setBrush(QColor(244, 67, 54, 150));
+  auto increaseErrors = new QCPErrorBars(customPlot->yAxis, customPlot->xAxis);
+  auto decreaseErrors = new QCPErrorBars(customPlot->yAxis, customPlot->xAxis);
+
+  QSharedPointer<QCPAxisTickerText> nameTicker(new QCPAxisTickerText);
+  double low = 0.0, high = 0.0;
+  for (int rank = 0; rank < order.size(); ++rank) {
+    int i = order[rank];
+    double key = rank + 1;
+    double coefficient = fit.coefficients[i];
+    bool increase = coefficient >= 0.0;
+    (increase ? increases : decreases)->addData(key, coefficient);
+    (increase ? increaseErrors : decreaseErrors)
+        ->addData(coefficient - fit.lower[i], fit.upper[i] - coefficient);
+    nameTicker->addTick(key, names[i]);
+    low = qMin(low, fit.lower[i]);
+    high = qMax(high, fit.upper[i]);
+  }
+  increaseErrors->setDataPlottable(increases);
+  decreaseErrors->setDataPlottable(decreases);
+  increaseErrors->removeFromLegend();
+  decreaseErrors->removeFromLegend();
+
+  // No effect at all
+  auto zeroLine = new QCPItemStraightLine(customPlot);
+  zeroLine->point1->setCoords(0, 0);
+  zeroLine->point2->setCoords(0, 1);
+  zeroLine->setPen(QPen(QColor(120, 120, 120), 1, Qt::DashLine));
+
+  customPlot->yAxis->setTicker(nameTicker);
+  customPlot->yAxis->setLabel("");
+  customPlot->xAxis->setTicker(
+      QSharedPointer<QCPAxisTicker>(new QCPAxisTicker));
+  customPlot->xAxis->setTickLabelRotation(0);
+  if (fit.ok) {
+    customPlot->xAxis->setLabel(
+        QString("Hours of sleep per unit of symptom, with 95% intervals\n"
+                "R² %1 (adjusted %2), %3 entries%4")
+            .arg(fit.rSquared, 0, 'f', 3)
+            .arg(fit.adjustedRSquared, 0, 'f', 3)
+            .arg(fit.observations)
+            .arg(fit.ridge > 0.0
+                     ? QString(", ridge %1").arg(fit.ridge, 0, 'f', 3)
+                     : QString()));
+  } else {
+    customPlot->xAxis->setLabel(fit.error);
+  }
+  double margin = qMax((high - low) * 0.05, 0.01);
+  customPlot->xAxis->setRange(low - margin, high + margin);
+  customPlot->yAxis->setRange(0.5, qMax(1, order.size()) + 0.5);
+
+  customPlot->legend->setVisible(!order.isEmpty());
+  customPlot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+  customPlot->axisRect()->insetLayout()->setInsetAlignment(
+      0, Qt::AlignBottom | Qt::AlignRight);
+
+  customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+  customPlot->replot();
+}
+
+void MainWindow::onRegressionInputsChanged() {
+  // One fit is a single pass over the range plus a solve the size of the
+  // symptom list, so the chart keeps up while the dates are edited
+  if (regressionSymptoms.isEmpty() || plotTypeSelector->currentIndex() != 4) {
+    return;
+  }
+  SleepTableView table = allDateRangeCheckbox->isChecked()
+                             ? entryStore->table().all()
+                             : entryStore->table().range(startDateEdit->date(),
+                                                         endDateEdit->date());
+  plotRegression(table, regressionSymptoms);
+}
+
+void MainWindow::plotHistogramStacked(const SleepTableView &table,
                                       const QStringList &selectedSymptoms) {
   // Clear previous synchronization
   for (QPointer<QCPAxis> xAxis : qAsConst(synchronizedXAxes)) {
@@ -1539,62 +1673,24 @@ void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
   histogramCustomPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom |
                                        QCP::iSelectPlottables);
 
-  QMap<QDate, QMap<QString, double>> dateData;
-
-  for (const auto &entry : entries) {
-    QDate date = entry["date"].toDate();
-    if (!date.isValid())
-      continue;
-
-    auto &dateMap = dateData[date];
-    for (const QString &s : selectedSymptoms)
-      if (!dateMap.contains(s))
-        dateMap[s] = 0.0;
-
-    for (const QString &s : selectedSymptoms) {
-      if (s == "Sleep Duration") {
-        dateMap[s] = entry["sleep_duration"].toDouble();
-      } else if (entry.contains(s)) {
-        QVariant value = entry[s];
-        if (value.type() == QVariant::Bool) {
-          if (value.toBool())
-            dateMap[s] += 1.0;
-        } else
-          dateMap[s] += value.toDouble();
-      }
-    }
-  }
-
-  QList<QDate> dates = dateData.keys();
-  std::sort(dates.begin(), dates.end());
-  if (dates.isEmpty()) {
+  histogramBars.clear();
+  if (table.isEmpty()) {
     histogramCustomPlot->replot();
     return;
   }
 
-  QVector<double> dateNumbers;
-  for (const QDate &date : dates)
-    dateNumbers.append(QDateTime(date).toMSecsSinceEpoch() / 1000.0);
-
-  double totalSeconds = dateNumbers.last() - dateNumbers.first();
-  double minDate = dateNumbers.first();
-  double maxDate = dateNumbers.last();
-  double xBuffer = (maxDate - minDate) * 0.1;
-  double barWidth =
-      totalSeconds / (dates.size() * selectedSymptoms.size() * 1.5);
-
-  QVector<QVector<double>> symptomValues(selectedSymptoms.size());
-  QVector<double> maxY(selectedSymptoms.size(), 0.0);
-
-  for (int i = 0; i < selectedSymptoms.size(); ++i) {
-    const QString &name = selectedSymptoms[i];
-    QVector<double> &vals = symptomValues[i];
-    for (const QDate &date : dates) {
-      double v = dateData[date].value(name, 0.0);
-      vals.append(v);
-      maxY[i] = std::max(maxY[i], v);
-    }
+  // Nightly to quarterly totals (averages for sleep duration), built once;
+  // the visible range picks the level
+  QStringList columns;
+  for (const QString &symptom : selectedSymptoms) {
+    columns.append(tableColumnFor(symptom));
   }
+  histogramRollup = RollupPyramid::build(table, columns);
+
+  double minDate = QDateTime(table.date(0)).toMSecsSinceEpoch() / 1000.0;
+  double maxDate =
+      QDateTime(table.date(table.rowCount() - 1)).toMSecsSinceEpoch() / 1000.0;
+  double xBuffer = qMax((maxDate - minDate) * 0.1, 86400.0);
 
   int numPlots = selectedSymptoms.size();
   synchronizedXAxes.clear();
@@ -1613,7 +1709,8 @@ void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
     // Configure axis rect for zooming and scrolling
     axisRect->setRangeDrag(
         Qt::Horizontal); // Allow horizontal dragging (scrolling)
-    axisRect->setRangeZoom(Qt::Vertical); // Allow vertical zooming
+    // Horizontal zoom moves between nightly and rolled-up bars
+    axisRect->setRangeZoom(Qt::Horizontal | Qt::Vertical);
     axisRect->setRangeZoomAxes(axisRect->axis(QCPAxis::atBottom),
                                axisRect->axis(QCPAxis::atLeft));
 
@@ -1622,28 +1719,15 @@ void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
     synchronizedXAxes.append(xAxis);
 
     auto bars = new QCPBars(xAxis, yAxis);
-    bars->setData(dateNumbers, symptomValues[i]);
     QColor color = colors[i % colors.size()];
     bars->setPen(QPen(color));
     bars->setBrush(QBrush(color));
-    bars->setWidth(barWidth);
+    histogramBars.append(bars);
 
-    // Set up date formatting for x-axis
-    QSharedPointer<QCPAxisTickerDateTime> ticker(new QCPAxisTickerDateTime);
-    ticker->setDateTimeFormat("MMM d");
-
-    if (i == numPlots - 1) {
-      xAxis->setTicker(ticker);
-      xAxis->setLabel("Date");
-    } else {
-      xAxis->setTicker(ticker);
+    if (i != numPlots - 1) {
       xAxis->setTickLabels(false); // Only show labels on bottom plot
     }
 
-    yAxis->setLabel(selectedSymptoms[i] == "Sleep Duration" ? "Hours"
-                                                            : "Count");
-    yAxis->setRange(0, maxY[i] * 1.25);
-
     // Set initial X range with some padding
     xAxis->setRange(minDate - xBuffer, maxDate + xBuffer);
 
@@ -1663,6 +1747,12 @@ void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
     }
   }
 
+  // The bottom axis follows every other, so it alone decides the level
+  QCPAxis *bottomAxis = synchronizedXAxes.last();
+  connect(bottomAxis, QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged),
+          this, &MainWindow::onHistogramRangeChanged, Qt::UniqueConnection);
+  showHistogramLevel(rollupLevelFor(bottomAxis));
+
   // Add context menu for resetting zoom
   histogramCustomPlot->setContextMenuPolicy(Qt::CustomContextMenu);
   connect(histogramCustomPlot, &QCustomPlot::customContextMenuRequested, this,
@@ -1672,6 +1762,58 @@ void MainWindow::plotHistogramStacked(const QList<QVariantMap> &entries,
   histogramCustomPlot->replot();
 }
 
+void MainWindow::showHistogramLevel(RollupPyramid::Level level) {
+  histogramLevel = level;
+
+  QVector<double> keys, values;
+  for (int i = 0; i < histogramBars.size(); ++i) {
+    QCPBars *bars = histogramBars[i];
+    if (!bars) {
+      continue;
+    }
+    bool sleep = histogramRollup.columnNames()[i] == "sleep_duration";
+    histogramRollup.series(level,
+                           i, sleep ? RollupPyramid::Statistic::Mean
+                                    : RollupPyramid::Statistic::Sum,
+                           keys, values);
+    bars->setData(keys, values, true);
+    bars->setWidth(RollupPyramid::bucketSeconds(level) * 0.8);
+
+    // Totals grow with the bucket, so each level gets its own y range
+    double maxY = 0.0;
+    for (double value : values) {
+      if (!qIsNaN(value)) {
+        maxY = qMax(maxY, value);
+      }
+    }
+    bars->valueAxis()->setRange(0, maxY > 0.0 ? maxY * 1.25 : 1.0);
+    QString per = level == RollupPyramid::Day
+                      ? QString()
+                      : QString(" (%1)").arg(RollupPyramid::levelName(level));
+    bars->valueAxis()->setLabel((sleep ? "Hours" : "Count") + per);
+
+    QSharedPointer<QCPAxisTickerDateTime> ticker(new QCPAxisTickerDateTime);
+    ticker->setDateTimeFormat(dateFormatFor(level));
+    bars->keyAxis()->setTicker(ticker);
+  }
+  if (!synchronizedXAxes.isEmpty() && synchronizedXAxes.last()) {
+    synchronizedXAxes.last()->setLabel("Date");
+  }
+}
+
+void MainWindow::onHistogramRangeChanged(const QCPRange &newRange) {
+  Q_UNUSED(newRange);
+  if (histogramBars.isEmpty() || synchronizedXAxes.isEmpty() ||
+      !synchronizedXAxes.last()) {
+    return;
+  }
+  RollupPyramid::Level level = rollupLevelFor(synchronizedXAxes.last());
+  if (level != histogramLevel) {
+    showHistogramLevel(level);
+    histogramCustomPlot->replot(QCustomPlot::rpQueuedReplot);
+  }
+}
+
 void MainWindow::resetHistogramZoom() {
   // Replot with original ranges
   // You might want to store the original date ranges and replot
@@ -1701,8 +1843,7 @@ void MainWindow::saveSymptoms() {
 
   // Save to user-specific encrypted binary file
   QString userSymptomsFile = getCurrentDataDirectory() + "/symptoms.dat";
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
+  SessionKey key = UserManager::instance().getCurrentUser()->getSessionKey();
 
   // Serialize to binary
   QByteArray data;
@@ -1715,7 +1856,7 @@ void MainWindow::saveSymptoms() {
     out << s.getName() << Symptom::typeToString(s.getType()) << s.getUnit();
   }
 
-  DataEncryption::saveEncrypted(userSymptomsFile, data, password);
+  DataEncryption::saveEncrypted(userSymptomsFile, data, key);
 }
 
 bool MainWindow::saveEntry() {
@@ -1725,15 +1866,8 @@ bool MainWindow::saveEntry() {
     return false;
   }
 
-  QString dataDir = getCurrentDataDirectory();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  // Generate unique filename with ID instead of date
+  // Records are keyed by a fresh ID instead of the date
   QUuid entryId = QUuid::createUuid();
-  QString filename = QString("%1/sleep_%2.dat")
-                         .arg(dataDir)
-                         .arg(entryId.toString(QUuid::WithoutBraces));
 
   // Calculate sleep duration
   QDateTime bedDateTime(dateEdit->date(), bedtimeEdit->time());
@@ -1763,30 +1897,18 @@ bool MainWindow::saveEntry() {
       << bedtimeEdit->time() << wakeupEdit->time() << hours << notes
       << symptomData;
 
-  if (!DataEncryption::saveEncrypted(filename, data, password)) {
+  // The detail record and the summary record are synced as one commit
+  StorageBatch batch;
+  if (!entryStore->details().write(entryId, data)) {
     QMessageBox::critical(this, "Error", "Could not save entry!");
     return false;
   }
 
-  return saveSummaryEntry(entryId);
+  bool saved = saveSummaryEntry(entryId);
+  return batch.commit() && saved;
 }
 
 bool MainWindow::saveSummaryEntry(const QUuid &entryId) {
-  QString symptomFile = getSymptomDataFile();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  // Load existing data
-  QList<QVariantMap> entries;
-  QByteArray existingData =
-      DataEncryption::loadEncrypted(symptomFile, password);
-
-  if (!existingData.isEmpty()) {
-    QDataStream in(&existingData, QIODevice::ReadOnly);
-    in.setVersion(QDataStream::Qt_5_15);
-    in >> entries;
-  }
-
   // Calculate sleep duration
   QDateTime bedDateTime(dateEdit->date(), bedtimeEdit->time());
   QDateTime wakeDateTime(dateEdit->date().addDays(1), wakeupEdit->time());
@@ -1808,34 +1930,9 @@ bool MainWindow::saveSummaryEntry(const QUuid &entryId) {
     entry[s.getName()] = s.getValue();
   }
 
-  // Check if entry with this ID already exists
-  bool entryExists = false;
-  int existingIndex = -1;
-  QString entryIdString = entryId.toString(QUuid::WithoutBraces);
-
-  for (int i = 0; i < entries.size(); ++i) {
-    if (entries[i]["id"].toString() == entryIdString) {
-      entryExists = true;
-      existingIndex = i;
-      break;
-    }
-  }
-
-  if (entryExists) {
-    // Update existing entry
-    entries[existingIndex] = entry;
-  } else {
-    // Add new entry
-    entries.append(entry);
-  }
-
-  // Serialize and save
-  QByteArray data;
-  QDataStream out(&data, QIODevice::WriteOnly);
-  out.setVersion(QDataStream::Qt_5_15);
-  out << entries;
-
-  return DataEncryption::saveEncrypted(symptomFile, data, password);
+  // An upsert replaces an existing entry with this ID or adds a new one, so
+  // saving never has to read the history
+  return entryStore->upsert(entry);
 }
 
 void MainWindow::setupUI() {
@@ -1869,8 +1966,8 @@ void MainWindow::setupUI() {
           &MainWindow::onTabChanged);
 
   // Pre-load data for the initially visible tab
-  QTimer::singleShot(0, this,
-                     [this]() { onTabChanged(tabWidget->currentIndex()); });
+  QTimer::singleShot(
+      0, this, [this]() { refreshTab(tabWidget->currentIndex(), false); });
 }
 
 void MainWindow::setupHistogramTab() {
@@ -1959,7 +2056,7 @@ void MainWindow::setupHistogramTab() {
 
   // Connect signals
   connect(generateHistogramButton, &QPushButton::clicked, this,
-          &MainWindow::loadHistogramData);
+          [this]() { loadHistogramData(true); });
   connect(histogramSelectAllButton, &QPushButton::clicked, this,
           &MainWindow::onHistogramSelectAllSymptoms);
   connect(histogramDeselectAllButton, &QPushButton::clicked, this,
@@ -2065,11 +2162,14 @@ void MainWindow::setupHistoryTab() {
   layout->addWidget(titleLabel);
 
   // History table
-  historyTable = new QTableWidget();
-  historyTable->setColumnCount(5);
-  historyTable->setHorizontalHeaderLabels(
-      {"Date", "Sleep Duration", "Bedtime", "Wake Time", "Symptoms"});
+  historyModel = new HistoryModel(entryStore, this);
+  historyTable = new QTableView();
+  historyTable->setModel(historyModel);
   historyTable->horizontalHeader()->setStretchLastSection(true);
+  // Size columns from the visible rows only, so no detail record is read
+  // for rows that are scrolled out of view
+  historyTable->horizontalHeader()->setResizeContentsPrecision(0);
+  historyTable->verticalHeader()->setResizeContentsPrecision(0);
   historyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
   historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
   historyTable->setAlternatingRowColors(true);
@@ -2084,16 +2184,22 @@ void MainWindow::setupHistoryTab() {
   auto exportButton = new QPushButton(tr("Export to CSV"), this);
   connect(exportButton, &QPushButton::clicked, this,
           &MainWindow::onExportHistoryToCSV);
+  auto importButton = new QPushButton(tr("Import from CSV"), this);
+  connect(importButton, &QPushButton::clicked, this,
+          &MainWindow::onImportHistoryFromCSV);
 
   buttonLayout->addStretch();
   buttonLayout->addWidget(exportButton);
+  buttonLayout->addWidget(importButton);
   buttonLayout->addWidget(refreshHistoryButton);
   buttonLayout->addWidget(deleteEntryButton);
   buttonLayout->addStretch();
   layout->addLayout(buttonLayout);
 
-  connect(historyTable, &QTableWidget::cellDoubleClicked, this,
-          &MainWindow::onHistoryDateSelected);
+  connect(historyTable, &QTableView::doubleClicked, this,
+          [this](const QModelIndex &index) {
+            onHistoryDateSelected(index.row(), index.column());
+          });
   connect(refreshHistoryButton, &QPushButton::clicked, this,
           &MainWindow::loadHistoryData);
   connect(deleteEntryButton, &QPushButton::clicked, this,
@@ -2117,7 +2223,9 @@ void MainWindow::setupStatisticsTab() {
   plotTypeSelector = new QComboBox();
   plotTypeSelector->addItem("Time Series (Line Chart)");
   plotTypeSelector->addItem("Histogram");
-  plotTypeSelector->addItem("Correlation View");
+  plotTypeSelector->addItem("Correlation Matrix (Heatmap)");
+  plotTypeSelector->addItem("Lag Analysis (vs Sleep Duration)");
+  plotTypeSelector->addItem("Regression (Sleep Duration on Symptoms)");
   controlLayout->addWidget(plotTypeSelector);
 
   // Histogram mode selector (only visible for histogram type)
@@ -2128,6 +2236,44 @@ void MainWindow::setupStatisticsTab() {
   histogramModeSelector->setVisible(false);
   controlLayout->addWidget(histogramModeSelector);
 
+  // Correlation method (only visible for correlation type)
+  correlationMethodSelector = new QComboBox();
+  correlationMethodSelector->addItem("Pearson (linear)");
+  correlationMethodSelector->addItem("Spearman (rank)");
+  correlationMethodSelector->setVisible(false);
+  controlLayout->addWidget(correlationMethodSelector);
+
+  // Lag range in days (only visible for lag analysis)
+  lagRangeWidget = new QWidget();
+  auto lagLayout = new QHBoxLayout(lagRangeWidget);
+  lagLayout->setContentsMargins(0, 0, 0, 0);
+  lagLayout->addWidget(new QLabel("Lags (days):"));
+  lagMinSpinBox = new QSpinBox();
+  lagMinSpinBox->setRange(-365, 365);
+  lagMinSpinBox->setValue(0);
+  lagLayout->addWidget(lagMinSpinBox);
+  lagLayout->addWidget(new QLabel("to"));
+  lagMaxSpinBox = new QSpinBox();
+  lagMaxSpinBox->setRange(-365, 365);
+  lagMaxSpinBox->setValue(14);
+  lagLayout->addWidget(lagMaxSpinBox);
+  lagRangeWidget->setVisible(false);
+  controlLayout->addWidget(lagRangeWidget);
+
+  // Ridge penalty (only visible for regression); 0 is plain least squares
+  ridgeWidget = new QWidget();
+  auto ridgeLayout = new QHBoxLayout(ridgeWidget);
+  ridgeLayout->setContentsMargins(0, 0, 0, 0);
+  ridgeLayout->addWidget(new QLabel("Ridge penalty:"));
+  ridgeSpinBox = new QDoubleSpinBox();
+  ridgeSpinBox->setRange(0.0, 10.0);
+  ridgeSpinBox->setDecimals(3);
+  ridgeSpinBox->setSingleStep(0.01);
+  ridgeSpinBox->setValue(0.0);
+  ridgeLayout->addWidget(ridgeSpinBox);
+  ridgeWidget->setVisible(false);
+  controlLayout->addWidget(ridgeWidget);
+
   // Date range
   controlLayout->addWidget(new QLabel("Date Range:"));
   allDateRangeCheckbox = new QCheckBox("Use all data");
@@ -2193,13 +2339,38 @@ void MainWindow::setupStatisticsTab() {
   infoLabel->setWordWrap(true);
   plotLayout->addWidget(infoLabel);
 
+  // Far right - summary of the whole history, independent of the plot
+  auto summaryLayout = new QVBoxLayout();
+
+  auto summaryTitle = new QLabel("Summary");
+  summaryTitle->setStyleSheet("font-size: 14px; font-weight: bold;");
+  summaryLayout->addWidget(summaryTitle);
+
+  statisticsSummaryTable = new QTableWidget(0, 9);
+  statisticsSummaryTable->setHorizontalHeaderLabels(
+      {"Metric", "N", "Mean", "SD", "Min", "Q1", "Median", "Q3", "Max"});
+  statisticsSummaryTable->verticalHeader()->setVisible(false);
+  statisticsSummaryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  statisticsSummaryTable->setSelectionMode(QAbstractItemView::NoSelection);
+  summaryLayout->addWidget(statisticsSummaryTable);
+
+  auto summaryInfoLabel = new QLabel(
+      "All entries, kept current as entries are saved, edited and deleted.");
+  summaryInfoLabel->setStyleSheet("color: #666; padding: 10px;");
+  summaryInfoLabel->setWordWrap(true);
+  summaryLayout->addWidget(summaryInfoLabel);
+
   // Add layouts to main
   mainLayout->addLayout(controlLayout, 1);
   mainLayout->addLayout(plotLayout, 3);
+  mainLayout->addLayout(summaryLayout, 2);
 
   // Connect signals
   connect(generatePlotButton, &QPushButton::clicked, this,
-          &MainWindow::loadStatisticsData);
+          [this]() { loadStatisticsData(true); });
+  connect(customPlot->xAxis,
+          QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged), this,
+          &MainWindow::onTimeSeriesRangeChanged);
   connect(plotTypeSelector, QOverload<int>::of(&QComboBox::currentIndexChanged),
           this, &MainWindow::onPlotTypeChanged);
   connect(selectAllButton, &QPushButton::clicked, this,
@@ -2210,6 +2381,64 @@ void MainWindow::setupStatisticsTab() {
     startDateEdit->setEnabled(!checked);
     endDateEdit->setEnabled(!checked);
   });
+  connect(allDateRangeCheckbox, &QCheckBox::toggled, this,
+          &MainWindow::onRegressionInputsChanged);
+  connect(startDateEdit, &QDateEdit::dateChanged, this,
+          &MainWindow::onRegressionInputsChanged);
+  connect(endDateEdit, &QDateEdit::dateChanged, this,
+          &MainWindow::onRegressionInputsChanged);
+  connect(ridgeSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+          this, &MainWindow::onRegressionInputsChanged);
+}
+
+void MainWindow::refreshStatisticsSummary() {
+  // Maintained by the entry store as entries change, so this only formats
+  const SummaryStatistics &statistics = entryStore->statistics();
+
+  QStringList columns = {"sleep_duration"};
+  for (const QString &name : symptomNames()) {
+    if (!columns.contains(name)) {
+      columns.append(name);
+    }
+  }
+  // Values of symptoms that are no longer defined
+  for (const QString &name : statistics.columnNames()) {
+    if (!columns.contains(name)) {
+      columns.append(name);
+    }
+  }
+
+  auto number = [](double value) {
+    return qIsNaN(value) ? QString("-") : QString::number(value, 'f', 2);
+  };
+
+  statisticsSummaryTable->setRowCount(0);
+  for (const QString &name : columns) {
+    const ColumnStatistics *column = statistics.column(name);
+    if (!column) {
+      continue;
+    }
+    int row = statisticsSummaryTable->rowCount();
+    statisticsSummaryTable->insertRow(row);
+    QStringList cells = {name == "sleep_duration" ? QString("Sleep Duration")
+                                                   : name,
+                         QString::number(column->count),
+                         number(column->mean),
+                         number(column->standardDeviation()),
+                         number(column->min),
+                         number(column->lowerQuartile()),
+                         number(column->median()),
+                         number(column->upperQuartile()),
+                         number(column->max)};
+    for (int c = 0; c < cells.size(); ++c) {
+      auto item = new QTableWidgetItem(cells[c]);
+      if (c > 0) {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      }
+      statisticsSummaryTable->setItem(row, c, item);
+    }
+  }
+  statisticsSummaryTable->resizeColumnsToContents();
 }
 
 void MainWindow::setupWordCloudTab() {
@@ -2307,7 +2536,7 @@ void MainWindow::setupWordCloudTab() {
 
   // Connect signals
   connect(generateWordCloudButton, &QPushButton::clicked, this,
-          &MainWindow::loadWordCloudData);
+          [this]() { loadWordCloudData(true); });
   connect(wordCloudAllDateRangeCheckbox, &QCheckBox::toggled,
           [this](bool checked) {
             wordCloudStartDateEdit->setEnabled(!checked);
@@ -2389,6 +2618,7 @@ void MainWindow::showAddSymptomDialog() {
         symptoms.append(Symptom(name, type, unit));
         saveSymptoms();
         rebuildSymptomWidgets();
+        entryStore->setColumnNames(symptomNames());
       } else {
         QMessageBox::information(this, "Duplicate",
                                  "This symptom already exists.");
@@ -2398,6 +2628,72 @@ void MainWindow::showAddSymptomDialog() {
 }
 
 void MainWindow::onExportHistoryToCSV() {
+  const SleepTable &history = entryStore->table();
+  if (history.isEmpty()) {
+    QMessageBox::warning(this, tr("Export Warning"),
+                         tr("No summary data found to export"));
+    return;
+  }
+
+  // Which nights and which columns to export
+  QDialog dialog(this);
+  dialog.setWindowTitle(tr("Export History to CSV"));
+  auto layout = new QVBoxLayout(&dialog);
+
+  auto allDatesCheckbox = new QCheckBox(tr("All dates"));
+  allDatesCheckbox->setChecked(true);
+  layout->addWidget(allDatesCheckbox);
+
+  auto rangeLayout = new QHBoxLayout();
+  auto startDateEdit = new QDateEdit(history.date(0));
+  auto endDateEdit = new QDateEdit(history.date(history.rowCount() - 1));
+  for (QDateEdit *edit : {startDateEdit, endDateEdit}) {
+    edit->setCalendarPopup(true);
+    edit->setDisplayFormat("yyyy-MM-dd");
+    edit->setEnabled(false);
+  }
+  rangeLayout->addWidget(new QLabel(tr("From:")));
+  rangeLayout->addWidget(startDateEdit);
+  rangeLayout->addWidget(new QLabel(tr("To:")));
+  rangeLayout->addWidget(endDateEdit);
+  layout->addLayout(rangeLayout);
+  connect(allDatesCheckbox, &QCheckBox::toggled, &dialog,
+          [startDateEdit, endDateEdit](bool all) {
+            startDateEdit->setEnabled(!all);
+            endDateEdit->setEnabled(!all);
+          });
+
+  // Id and duration first, then the symptom columns in the table's order
+  layout->addWidget(new QLabel(tr("Columns:")));
+  auto columnList = new QListWidget();
+  QStringList columnNames = {tr("Id"), tr("Sleep Duration")};
+  columnNames << history.columnNames();
+  for (const QString &name : columnNames) {
+    auto item = new QListWidgetItem(name, columnList);
+    item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+    item->setCheckState(Qt::Checked);
+  }
+  layout->addWidget(columnList);
+
+  auto buttons =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  layout->addWidget(buttons);
+
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+
+  CsvExporter::Options options;
+  options.includeId = columnList->item(0)->checkState() == Qt::Checked;
+  options.includeDuration = columnList->item(1)->checkState() == Qt::Checked;
+  for (int i = 2; i < columnList->count(); ++i) {
+    if (columnList->item(i)->checkState() == Qt::Checked) {
+      options.symptoms << history.columnNames()[i - 2];
+    }
+  }
+
   QString fileName = QFileDialog::getSaveFileName(
       this, tr("Export History to CSV"),
       QString("sleepbook_history_%1.csv")
@@ -2405,12 +2701,80 @@ void MainWindow::onExportHistoryToCSV() {
       tr("CSV Files (*.csv)"));
 
   if (!fileName.isEmpty()) {
-    QList<QVariantMap> entries =
-        loadSummaryData(); // This now uses loadAllEntries()
-    exportHistoryToCSV(fileName, entries);
+    exportHistoryToCSV(fileName,
+                       allDatesCheckbox->isChecked()
+                           ? history.all()
+                           : history.range(startDateEdit->date(),
+                                           endDateEdit->date()),
+                       options);
   }
 }
 
+void MainWindow::onImportHistoryFromCSV() {
+  if (!entryStore->isOpen()) {
+    QMessageBox::information(this, tr("Import"),
+                             tr("Your data is still being loaded. Please try "
+                                "again in a moment."));
+    return;
+  }
+
+  QString fileName = QFileDialog::getOpenFileName(
+      this, tr("Import History from CSV"), QString(),
+      tr("CSV Files (*.csv);;All Files (*)"));
+  if (fileName.isEmpty()) {
+    return;
+  }
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    QMessageBox::warning(this, tr("Import Error"),
+                         tr("Could not open file for reading: %1").arg(fileName));
+    return;
+  }
+
+  // Parsed in one streaming pass, then stored in one batch
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  CsvImporter importer(symptoms);
+  bool parsed = importer.read(file);
+  file.close();
+
+  if (!parsed) {
+    QApplication::restoreOverrideCursor();
+    QMessageBox::warning(this, tr("Import Error"), importer.error());
+    return;
+  }
+
+  // Columns with no symptom yet are added before the entries that use them
+  if (!importer.newSymptoms().isEmpty()) {
+    symptoms.append(importer.newSymptoms());
+    saveSymptoms();
+    rebuildSymptomWidgets();
+    entryStore->setColumnNames(symptomNames());
+  }
+
+  EntryStore::ImportReport imported =
+      entryStore->importEntries(importer.entries());
+  QApplication::restoreOverrideCursor();
+
+  if (!imported.ok) {
+    QMessageBox::warning(this, tr("Import Error"),
+                         tr("The imported entries could not be saved."));
+    return;
+  }
+
+  QMessageBox::information(
+      this, tr("Import Complete"),
+      tr("%1 entries imported from %2 rows.\n%3 rows had no readable date, "
+         "%4 were already in your history and %5 repeated an earlier row."
+         "\n%6 new symptoms were added.")
+          .arg(imported.added)
+          .arg(importer.rows())
+          .arg(importer.skipped())
+          .arg(imported.existing)
+          .arg(imported.duplicates)
+          .arg(importer.newSymptoms().size()));
+}
+
 void MainWindow::syncXAxes(const QCPRange &newRange) {
   auto senderAxis = qobject_cast<QCPAxis *>(sender());
   if (!senderAxis || !customPlot || !customPlot->plotLayout())
@@ -2449,53 +2813,17 @@ void MainWindow::updateWindowTitle() {
 bool MainWindow::updateSummaryEntry(
     const QUuid &entryId, const QDate &newDate, double duration,
     const QList<QPair<QString, double>> &symptomData) {
-  QString symptomFile = getSymptomDataFile();
-  QString password =
-      UserManager::instance().getCurrentUser()->getEncryptionPassword();
-
-  // Load existing summary entries
-  QList<QVariantMap> entries;
-  QByteArray existingData =
-      DataEncryption::loadEncrypted(symptomFile, password);
-
-  if (!existingData.isEmpty()) {
-    QDataStream in(&existingData, QIODevice::ReadOnly);
-    in.setVersion(QDataStream::Qt_5_15);
-    in >> entries;
-  }
-
-  // Find and update the existing entry by ID
-  bool entryFound = false;
-  QString entryIdString = entryId.toString(QUuid::WithoutBraces);
-
-  for (int i = 0; i < entries.size(); ++i) {
-    QVariantMap &entry = entries[i];
-
-    if (entry["id"].toString() == entryIdString) {
-      // Update existing entry with new date and other data
-      entry["date"] = newDate;
-      entry["sleep_duration"] = duration;
-
-      // Update symptom values
-      for (const auto &pair : symptomData) {
-        entry[pair.first] = pair.second;
-      }
-
-      entryFound = true;
-      break;
-    }
-  }
-
-  if (!entryFound) {
-    qWarning() << "Entry not found in summary for ID:" << entryIdString;
-    return false;
+  // Only the changed fields are journaled; they are merged into the existing
+  // entry with this ID on replay
+  QVariantMap changes;
+  changes["id"] = entryId.toString(QUuid::WithoutBraces);
+  changes["date"] = newDate;
+  changes["sleep_duration"] = duration;
+
+  // Update symptom values
+  for (const auto &pair : symptomData) {
+    changes[pair.first] = pair.second;
   }
 
-  // Save updated entries back to summary file
-  QByteArray data;
-  QDataStream out(&data, QIODevice::WriteOnly);
-  out.setVersion(QDataStream::Qt_5_15);
-  out << entries;
-
-  return DataEncryption::saveEncrypted(symptomFile, data, password);
+  return entryStore->merge(changes);
 }
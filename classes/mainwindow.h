@@ -23,6 +23,7 @@
 #include <QComboBox>
 #include <QTabWidget>
 #include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
 #include <QListWidget>
 #include <QDateEdit>
@@ -37,52 +38,23 @@
 #include <QWidget>
 #include <QTimer>
 #include <QRandomGenerator>
+#include <QSet>
 #include "symptom.h"
 #include "symptomwidget.h"
 #include "usermanager.h"
 #include "dataencryption.h"
 #include "qcustomplot.h"
 #include "wordcloudwidget.h"
-
+#include "detailloader.h"
+#include "entrystore.h"
+#include "sleepentry.h"
+#include "historymodel.h"
+#include "csvexporter.h"
+#include "rolluppyramid.h"
+
+class LegacyMigration;
 class WordCloudWidget;
 
-struct SleepEntry {
-    QUuid id;
-    QDateTime timestamp;
-    QDate date;
-    QTime bedtime;
-    QTime waketime;
-    double hours;
-    QString notes;
-    QList<QPair<QString, double>> symptomData;
-
-    SleepEntry() : id(QUuid::createUuid()), hours(0.0) {}
-    SleepEntry(const QUuid &entryId) : id(entryId), hours(0.0) {}
-
-    // Helper method to convert to/from QVariantMap for summary data
-    QVariantMap toVariantMap() const {
-        QVariantMap map;
-        map["id"] = id.toString(QUuid::WithoutBraces);
-        map["date"] = date;
-        map["sleep_duration"] = hours;
-
-        for (const auto &pair : symptomData) {
-            map[pair.first] = pair.second;
-        }
-        return map;
-    }
-
-    static SleepEntry fromVariantMap(const QVariantMap &map) {
-        SleepEntry entry(QUuid::fromString(map["id"].toString()));
-        entry.date = map["date"].toDate();
-        entry.hours = map["sleep_duration"].toDouble();
-
-        // Note: symptomData would need to be populated separately
-        return entry;
-    }
-};
-
-
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -101,14 +73,24 @@ public:
 
     void onLogout();
 
+    void onReindex();
+
     void onUserChanged();
 
     void onTabChanged(int index);
 
+    void onEntriesChanged();
+
+    void onWordCloudEntriesLoaded(const QVector<SleepEntry> &entries);
+
+    void onWordCloudLoadFinished();
+
     void onHistoryDateSelected(int row, int column);
 
     void onExportHistoryToCSV();
 
+    void onImportHistoryFromCSV();
+
     void onDeleteHistoryEntry();
 
     void onPlotTypeChanged(int index);
@@ -119,16 +101,23 @@ public:
 
     void syncXAxes(const QCPRange &newRange);
 
+    void onTimeSeriesRangeChanged(const QCPRange &newRange);
+
+    void onHistogramRangeChanged(const QCPRange &newRange);
+
+    void onRegressionInputsChanged();
+
 private:
     void setupUI();
 
-    void loadHistogramData();
+    void loadHistogramData(bool userInitiated);
 
     void onHistogramSelectAllSymptoms();
 
     void onHistogramDeselectAllSymptoms();
 
-    void exportHistoryToCSV(const QString& filename, const QList<QVariantMap>& entries);
+    void exportHistoryToCSV(const QString& filename, const SleepTableView& table,
+                            const CsvExporter::Options& options);
 
     void setupEntryTab();
 
@@ -162,20 +151,26 @@ private:
 
     void loadHistoryData();
 
-    void loadStatisticsData();
+    void loadStatisticsData(bool userInitiated);
 
-    void loadWordCloudData();
+    void refreshStatisticsSummary();
 
-    static QList<QVariantMap> loadAllEntries();
+    void loadWordCloudData(bool userInitiated);
 
-    QList<QVariantMap> filterEntriesByDateRange(const QList<QVariantMap> &entries, const QDate &start,
-                                                const QDate &end);
+    // Loads a stale tab; automatic refreshes pass false and show no dialogs
+    void refreshTab(int index, bool userInitiated);
 
-    void plotTimeSeriesData(const QList<QVariantMap> &entries, const QStringList &selectedSymptoms);
+    void openEntryStore();
 
-    void plotHistogramData(const QList<QVariantMap> &entries, const QStringList &selectedSymptoms);
+    QStringList symptomNames() const;
 
-    void plotHistogramOverlay(const QList<QVariantMap> &entries, const QStringList &selectedSymptoms);
+    void plotTimeSeriesData(const SleepTableView &table, const QStringList &selectedSymptoms);
+
+    void showTimeSeriesLevel(RollupPyramid::Level level);
+
+    void plotHistogramData(const SleepTableView &table, const QStringList &selectedSymptoms);
+
+    void plotHistogramOverlay(const SleepTableView &table, const QStringList &selectedSymptoms);
 
     void initializeHistogram() const;
 
@@ -183,9 +178,17 @@ private:
 
     void resetHistogramZoom();
 
-    void plotHistogramStacked(const QList<QVariantMap> &entries, const QStringList &selectedSymptoms);
+    void plotHistogramStacked(const SleepTableView &table, const QStringList &selectedSymptoms);
+
+    void showHistogramLevel(RollupPyramid::Level level);
+
+    void plotCorrelationData(const SleepTableView &table, const QStringList &selectedSymptoms);
+
+    void resetStatisticsPlot();
 
-    void plotCorrelationData(const QList<QVariantMap> &entries, const QStringList &selectedSymptoms);
+    void plotLaggedCorrelation(const SleepTableView &table, const QStringList &selectedSymptoms);
+
+    void plotRegression(const SleepTableView &table, const QStringList &selectedSymptoms);
 
     bool updateSummaryEntry(const QUuid &entryId, const QDate &newDate,
                             double duration,
@@ -219,7 +222,8 @@ private:
 
     // History tab
     QWidget *historyTab;
-    QTableWidget *historyTable;
+    QTableView *historyTable;
+    HistoryModel *historyModel;
     QPushButton *deleteEntryButton;
     QPushButton *refreshHistoryButton;
 
@@ -232,7 +236,14 @@ private:
     QDateEdit *endDateEdit;
     QCheckBox *allDateRangeCheckbox;
     QComboBox *histogramModeSelector;
+    QComboBox *correlationMethodSelector;
+    QWidget *lagRangeWidget;
+    QSpinBox *lagMinSpinBox;
+    QSpinBox *lagMaxSpinBox;
+    QWidget *ridgeWidget;
+    QDoubleSpinBox *ridgeSpinBox;
     QCustomPlot *customPlot;
+    QTableWidget *statisticsSummaryTable;
     QPushButton *generatePlotButton;
     QPushButton *selectAllButton;
     QPushButton *deselectAllButton;
@@ -268,14 +279,42 @@ private:
     // User toolbar
     QToolBar *userToolbar;
     QLabel *userLabel;
+    QPushButton *reindexButton;
     QPushButton *logoutButton;
 
+    // Session cache of the summary history
+    EntryStore *entryStore;
+    QSet<QWidget *> staleTabs;
+    // Redraws the visible tab once per burst of entry changes
+    QTimer *visibleTabRefresh;
+
+    // Moves files from older versions into the store once per data directory
+    LegacyMigration *legacyMigration;
+
+    // Word cloud state, filled in as note batches arrive
+    DetailLoader *wordCloudLoader;
+    QMap<QString, int> wordCloudFrequencies;
+    int wordCloudTotalWords = 0;
+    int wordCloudEntriesWithNotes = 0;
+
     QList<Symptom> symptoms;
     QList<SymptomWidget *> symptomWidgets;
     QVector<QPointer<QCPAxis> > synchronizedXAxes;
-
-    QList<QVariantMap> loadSummaryData();
-    QStringList parseCSVLine(const QString& line);
+    QPointer<QCPColorScale> correlationScale;
+    QPointer<QCPMarginGroup> correlationMarginGroup;
+
+    // Time series and stacked histogram draw from rollups; the level
+    // follows the visible range as the plots are zoomed and dragged
+    RollupPyramid timeSeriesRollup;
+    QVector<QPointer<QCPGraph> > timeSeriesGraphs;
+    RollupPyramid::Level timeSeriesLevel = RollupPyramid::Day;
+    RollupPyramid histogramRollup;
+    QVector<QPointer<QCPBars> > histogramBars;
+    RollupPyramid::Level histogramLevel = RollupPyramid::Day;
+
+    // Selection behind the regression chart, re-fitted as the date range
+    // or penalty changes; empty while another plot is shown
+    QStringList regressionSymptoms;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,131 @@
+//created by drmrsthemonarch with ai effort
+#include "reindex.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtGlobal>
+
+namespace {
+bool sameValue(const QVariant& a, const QVariant& b) {
+    if (a.type() == QVariant::Date || b.type() == QVariant::Date) {
+        return a.toDate() == b.toDate();
+    }
+    // Snapshot records hold doubles; stored values round-trip exactly, so
+    // only a value saved under another type can differ in the last bits
+    double x = a.toDouble();
+    double y = b.toDouble();
+    return x == y || qFuzzyCompare(1.0 + x, 1.0 + y);
+}
+
+QString milliseconds(qint64 nsecs) {
+    return QString::number(nsecs / 1e6, 'f', 1) + " ms";
+}
+}
+
+bool Reindex::matches(const QVariantMap& summary, const QVariantMap& derived) {
+    if (summary.size() != derived.size()) {
+        return false;
+    }
+    for (auto field = derived.constBegin(); field != derived.constEnd(); ++field) {
+        auto other = summary.constFind(field.key());
+        if (other == summary.constEnd()) {
+            return false;
+        }
+        if (field.key() == "id" ? other.value().toString() != field.value().toString()
+                                : !sameValue(other.value(), field.value())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Reindex::Report Reindex::run(DetailStore& details, const SummaryEntries& current,
+                             QList<QVariantMap>* rebuilt) {
+    Report report;
+    report.summaryEntries = current.size();
+    QElapsedTimer timer;
+
+    // The index is only a cache of the pack; rebuild it first so the scan
+    // below reads exactly what the pack holds
+    timer.start();
+    report.indexCorrected = details.rebuildIndex();
+    report.indexNsecs = timer.nsecsElapsed();
+    if (report.indexCorrected < 0) {
+        report.indexCorrected = 0;
+        report.ok = false;
+        return report;
+    }
+
+    timer.restart();
+    DetailStore::ReadPlan plan = details.planRead(details.ids());
+    report.detailRecords = plan.records.size();
+    for (const auto& record : qAsConst(plan.records)) {
+        report.bytes += record.first.length;
+    }
+    QFile pack(plan.packFile);
+    if (!pack.open(QIODevice::ReadOnly)) {
+        report.ok = false;
+        return report;
+    }
+    QVector<SleepEntry> entries = DetailStore::readEntries(pack, plan, 0, plan.records.size());
+    report.scanNsecs = timer.nsecsElapsed();
+
+    // Compare in night order, which is how readEntries hands them back
+    timer.restart();
+    QHash<QString, QVariantMap> derived;
+    derived.reserve(entries.size());
+    QList<QVariantMap> added;
+    for (const SleepEntry& entry : qAsConst(entries)) {
+        if (!entry.date.isValid()) {
+            continue;
+        }
+        QVariantMap map = entry.toVariantMap();
+        QString id = map.value("id").toString();
+        int index = current.indexOf(id);
+        if (index < 0) {
+            ++report.missing;
+            added.append(map);
+        } else if (!matches(current.at(index), map)) {
+            ++report.mismatched;
+        }
+        derived.insert(id, map);
+    }
+    report.unreadable = report.detailRecords - derived.size();
+    report.orphaned = current.size() - (derived.size() - added.size());
+
+    if (rebuilt) {
+        rebuilt->clear();
+        rebuilt->reserve(current.size() + added.size());
+        for (int i = 0; i < current.size(); ++i) {
+            const QVariantMap& entry = current.at(i);
+            rebuilt->append(derived.value(entry.value("id").toString(), entry));
+        }
+        rebuilt->append(added);
+    }
+    report.verifyNsecs = timer.nsecsElapsed();
+    return report;
+}
+
+QString Reindex::Report::toString() const {
+    if (!ok) {
+        return "The detail records could not be read.";
+    }
+
+    double seconds = qMax<qint64>(scanNsecs, 1) / 1e9;
+    QString text;
+    text += QString("Detail records: %1 (%2 unreadable)\n").arg(detailRecords).arg(unreadable);
+    text += QString("Index: rebuilt in %1, %2 entries corrected\n")
+                .arg(milliseconds(indexNsecs))
+                .arg(indexCorrected);
+    text += QString("Scan: %1 MB in %2 (%3 MB/s, %4 records/s)\n")
+                .arg(bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                .arg(milliseconds(scanNsecs))
+                .arg(bytes / (1024.0 * 1024.0) / seconds, 0, 'f', 1)
+                .arg(qRound64(detailRecords / seconds));
+    text += QString("Summary: %1 entries, %2 missing, %3 out of date, %4 without details\n")
+                .arg(summaryEntries)
+                .arg(missing)
+                .arg(mismatched)
+                .arg(orphaned);
+    text += QString("Verify: %1").arg(milliseconds(verifyNsecs));
+    return text;
+}
@@ -0,0 +1,48 @@
+//created by drmrsthemonarch with ai effort
+#ifndef REINDEX_H
+#define REINDEX_H
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include "detailstore.h"
+#include "summaryentries.h"
+
+// Rebuilds what can be derived from the detail records: the pack index,
+// then the summary history, which otherwise is only kept in step with the
+// details by every save writing both. All records are read in one pass and
+// decrypted across the thread pool. Used to repair a store that drifted
+// and, through storagebench, to measure full-scan throughput.
+class Reindex {
+public:
+    struct Report {
+        int detailRecords = 0;   // live records in the pack
+        int unreadable = 0;      // failed authentication or did not parse
+        int indexCorrected = 0;  // ids the old pack index had wrong
+        int summaryEntries = 0;  // in the summary before the rebuild
+        int missing = 0;         // detail records with no summary entry
+        int mismatched = 0;      // summary entries that disagree with their details
+        int orphaned = 0;        // summary entries with no details; kept as they are
+        qint64 bytes = 0;        // encrypted bytes read
+        qint64 indexNsecs = 0;
+        qint64 scanNsecs = 0;
+        qint64 verifyNsecs = 0;
+        bool ok = true;
+
+        bool isConsistent() const {
+            return ok && indexCorrected == 0 && missing == 0 && mismatched == 0;
+        }
+        QString toString() const;
+    };
+
+    // rebuilt, if given, receives the summary derived from the details: the
+    // current order with every entry replaced by its details, orphans kept,
+    // and entries for the missing nights appended in night order
+    static Report run(DetailStore& details, const SummaryEntries& current,
+                      QList<QVariantMap>* rebuilt = nullptr);
+
+    // Same id, night, duration and symptom values
+    static bool matches(const QVariantMap& summary, const QVariantMap& derived);
+};
+
+#endif // REINDEX_H
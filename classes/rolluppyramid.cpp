@@ -0,0 +1,199 @@
+//created by drmrsthemonarch with ai effort
+#include "rolluppyramid.h"
+#include <QDateTime>
+#include <limits>
+
+namespace {
+// Average calendar days per bucket, for picking a level
+const double LevelDays[RollupPyramid::LevelCount] = {1.0, 7.0, 30.44, 91.31};
+
+const double SecondsPerDay = 86400.0;
+
+qint64 weekStart(qint64 day) {
+    return day - (QDate::fromJulianDay(day).dayOfWeek() - 1);
+}
+
+qint64 nextWeek(qint64 start) {
+    return start + 7;
+}
+
+qint64 monthStart(qint64 day) {
+    QDate date = QDate::fromJulianDay(day);
+    return QDate(date.year(), date.month(), 1).toJulianDay();
+}
+
+qint64 nextMonth(qint64 start) {
+    return QDate::fromJulianDay(start).addMonths(1).toJulianDay();
+}
+
+qint64 quarterStart(qint64 day) {
+    QDate date = QDate::fromJulianDay(day);
+    return QDate(date.year(), (date.month() - 1) / 3 * 3 + 1, 1).toJulianDay();
+}
+
+qint64 nextQuarter(qint64 start) {
+    return QDate::fromJulianDay(start).addMonths(3).toJulianDay();
+}
+}
+
+void RollupPyramid::appendBucket(Buckets& buckets, qint64 start, int length) {
+    buckets.starts.append(start);
+    // Same local-midnight seconds the plots use for a night
+    double first = QDateTime(QDate::fromJulianDay(start)).toMSecsSinceEpoch() / 1000.0;
+    buckets.keys.append(first + (length - 1) * SecondsPerDay / 2.0);
+    for (Aggregates& column : buckets.columns) {
+        column.sum.append(0.0);
+        column.min.append(std::numeric_limits<double>::quiet_NaN());
+        column.max.append(std::numeric_limits<double>::quiet_NaN());
+        column.count.append(0);
+    }
+}
+
+RollupPyramid RollupPyramid::build(const SleepTableView& table, const QStringList& columns) {
+    RollupPyramid pyramid;
+    pyramid.m_columns = columns;
+    for (Buckets& level : pyramid.m_levels) {
+        level.columns.resize(columns.size());
+    }
+
+    QVector<const double*> series;
+    QVector<int> indexes;
+    for (const QString& name : columns) {
+        int index = name == "sleep_duration" ? -1 : table.columnIndex(name);
+        indexes.append(index);
+        series.append(name == "sleep_duration" ? table.sleepDuration()
+                      : index >= 0              ? table.column(index)
+                                                : nullptr);
+    }
+
+    // Nights; rows are sorted by date, so entries of one night are adjacent
+    Buckets& nights = pyramid.m_levels[Day];
+    const qint64* days = table.days();
+    const int rows = table.rowCount();
+    for (int first = 0; first < rows;) {
+        int last = first + 1;
+        while (last < rows && days[last] == days[first]) {
+            ++last;
+        }
+        appendBucket(nights, days[first], 1);
+        int bucket = nights.starts.size() - 1;
+
+        for (int c = 0; c < columns.size(); ++c) {
+            if (!series[c]) {
+                continue;
+            }
+            double value = 0.0;
+            bool recorded = false;
+            if (indexes[c] < 0) {
+                value = series[c][last - 1];
+                recorded = true;
+            } else {
+                for (int row = first; row < last; ++row) {
+                    if (table.isPresent(indexes[c], row)) {
+                        value += series[c][row];
+                        recorded = true;
+                    }
+                }
+            }
+            if (recorded) {
+                Aggregates& column = nights.columns[c];
+                column.sum[bucket] = value;
+                column.min[bucket] = value;
+                column.max[bucket] = value;
+                column.count[bucket] = 1;
+            }
+        }
+        first = last;
+    }
+
+    pyramid.merge(Day, Week, weekStart, nextWeek);
+    pyramid.merge(Day, Month, monthStart, nextMonth);
+    pyramid.merge(Month, Quarter, quarterStart, nextQuarter);
+    return pyramid;
+}
+
+void RollupPyramid::merge(Level from, Level to, qint64 (*startOf)(qint64),
+                          qint64 (*nextStart)(qint64)) {
+    const Buckets& source = m_levels[from];
+    Buckets& target = m_levels[to];
+    for (int i = 0; i < source.starts.size(); ++i) {
+        qint64 start = startOf(source.starts[i]);
+        if (target.starts.isEmpty() || target.starts.last() != start) {
+            appendBucket(target, start, int(nextStart(start) - start));
+        }
+        int bucket = target.starts.size() - 1;
+
+        for (int c = 0; c < m_columns.size(); ++c) {
+            const Aggregates& in = source.columns[c];
+            if (in.count[i] == 0) {
+                continue;
+            }
+            Aggregates& out = target.columns[c];
+            out.sum[bucket] += in.sum[i];
+            out.min[bucket] = out.count[bucket] > 0 ? qMin(out.min[bucket], in.min[i]) : in.min[i];
+            out.max[bucket] = out.count[bucket] > 0 ? qMax(out.max[bucket], in.max[i]) : in.max[i];
+            out.count[bucket] += in.count[i];
+        }
+    }
+}
+
+RollupPyramid::Level RollupPyramid::levelFor(double days, int maxBuckets) {
+    for (int level = Day; level < Quarter; ++level) {
+        if (days / LevelDays[level] <= maxBuckets) {
+            return Level(level);
+        }
+    }
+    return Quarter;
+}
+
+QString RollupPyramid::levelName(Level level) {
+    switch (level) {
+    case Day:
+        return "nightly";
+    case Week:
+        return "weekly";
+    case Month:
+        return "monthly";
+    case Quarter:
+        return "quarterly";
+    }
+    return QString();
+}
+
+void RollupPyramid::series(Level level, int column, Statistic statistic, QVector<double>& keys,
+                           QVector<double>& values) const {
+    const Buckets& buckets = m_levels[level];
+    const Aggregates& aggregates = buckets.columns[column];
+    const int count = buckets.starts.size();
+    keys = buckets.keys;
+    values.resize(count);
+    for (int i = 0; i < count; ++i) {
+        int n = aggregates.count[i];
+        double value = std::numeric_limits<double>::quiet_NaN();
+        if (statistic == Statistic::Count) {
+            value = n;
+        } else if (n > 0) {
+            switch (statistic) {
+            case Statistic::Sum:
+                value = aggregates.sum[i];
+                break;
+            case Statistic::Mean:
+                value = aggregates.sum[i] / n;
+                break;
+            case Statistic::Min:
+                value = aggregates.min[i];
+                break;
+            case Statistic::Max:
+                value = aggregates.max[i];
+                break;
+            case Statistic::Count:
+                break;
+            }
+        }
+        values[i] = value;
+    }
+}
+
+double RollupPyramid::bucketSeconds(Level level) {
+    return LevelDays[level] * SecondsPerDay;
+}
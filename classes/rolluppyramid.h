@@ -0,0 +1,61 @@
+//created by drmrsthemonarch with ai effort
+#ifndef ROLLUPPYRAMID_H
+#define ROLLUPPYRAMID_H
+
+#include <QStringList>
+#include <QVector>
+#include "sleeptable.h"
+
+// Per-column aggregates of a table by night, week, month and quarter, so a
+// plot can draw whichever level suits its visible range without touching
+// the rows again. Nights are built from the table in one pass; weeks and
+// months merge nights, and quarters merge months.
+class RollupPyramid {
+public:
+    enum Level { Day, Week, Month, Quarter };
+    static const int LevelCount = 4;
+
+    enum class Statistic { Sum, Mean, Count, Min, Max };
+
+    // Columns by table name, sleep_duration included. A symptom's night is
+    // the sum over that night's entries; sleep_duration is the last entry's.
+    // Nights that did not record a column do not count towards it.
+    static RollupPyramid build(const SleepTableView& table, const QStringList& columns);
+
+    // Finest level that shows at most maxBuckets buckets over a span of days
+    static Level levelFor(double days, int maxBuckets);
+    static QString levelName(Level level);
+
+    const QStringList& columnNames() const { return m_columns; }
+    int bucketCount(Level level) const { return m_levels[level].starts.size(); }
+
+    // One key per bucket (seconds since the epoch, at the middle of the
+    // bucket's first and last day) with the statistic of one column; NaN
+    // where the bucket has no value for it
+    void series(Level level, int column, Statistic statistic, QVector<double>& keys,
+                QVector<double>& values) const;
+    // Average width of a bucket in seconds, for bars
+    static double bucketSeconds(Level level);
+
+private:
+    struct Aggregates {
+        QVector<double> sum;
+        QVector<double> min;
+        QVector<double> max;
+        QVector<int> count;
+    };
+    struct Buckets {
+        QVector<qint64> starts; // Julian day of the first day
+        QVector<double> keys;
+        QVector<Aggregates> columns;
+    };
+
+    // Merges the buckets of one level into those of a coarser one
+    void merge(Level from, Level to, qint64 (*startOf)(qint64), qint64 (*nextStart)(qint64));
+    static void appendBucket(Buckets& buckets, qint64 start, int length);
+
+    QStringList m_columns;
+    Buckets m_levels[LevelCount];
+};
+
+#endif // ROLLUPPYRAMID_H
@@ -0,0 +1,65 @@
+//created by drmrsthemonarch with ai effort
+#include "sessionkey.h"
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <QtEndian>
+
+namespace {
+// PBKDF2-HMAC-SHA256 (RFC 8018) for a single 32-byte block
+QByteArray pbkdf2Sha256(const QByteArray& password, const QByteArray& salt, int iterations) {
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+
+    uchar blockIndex[4];
+    qToBigEndian(quint32(1), blockIndex);
+    mac.addData(salt);
+    mac.addData(reinterpret_cast<const char*>(blockIndex), 4);
+    QByteArray u = mac.result();
+    QByteArray derived = u;
+
+    for (int i = 1; i < iterations; ++i) {
+        // reset() keeps the key, so only the message is rehashed
+        mac.reset();
+        mac.addData(u);
+        u = mac.result();
+        for (int j = 0; j < derived.size(); ++j) {
+            derived[j] = derived[j] ^ u[j];
+        }
+    }
+    return derived;
+}
+}
+
+SessionKey SessionKey::derive(const QString& password, const QByteArray& salt, int iterations) {
+    QByteArray utf8 = password.toUtf8();
+
+    SessionKey key;
+    key.m_masterKey = pbkdf2Sha256(utf8, salt, qMax(1, iterations));
+    key.m_legacyKey = QCryptographicHash::hash(utf8, QCryptographicHash::Sha256);
+    key.m_cipherKey = key.subkey("sleepbook-chacha20-poly1305");
+    return key;
+}
+
+QByteArray SessionKey::generateSalt() {
+    quint32 words[SaltSize / 4];
+    QRandomGenerator::system()->fillRange(words);
+    return QByteArray(reinterpret_cast<const char*>(words), SaltSize);
+}
+
+void SessionKey::clear() {
+    m_masterKey.clear();
+    m_legacyKey.clear();
+    m_cipherKey.clear();
+}
+
+QByteArray SessionKey::subkey(const QByteArray& purpose) const {
+    return QMessageAuthenticationCode::hash(purpose, m_masterKey, QCryptographicHash::Sha256);
+}
+
+QByteArray SessionKey::fileKey(const QByteArray& salt) const {
+    return QMessageAuthenticationCode::hash(salt, m_cipherKey, QCryptographicHash::Sha256);
+}
+
+QString SessionKey::verifier() const {
+    return QString(subkey("sleepbook-login-verifier").toHex());
+}
@@ -0,0 +1,52 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SESSIONKEY_H
+#define SESSIONKEY_H
+
+#include <QByteArray>
+#include <QString>
+
+// Key material for one login session, derived from the password exactly
+// once in UserManager::authenticateUser. Everything that encrypts or
+// decrypts takes a SessionKey, so no file access hashes the password again
+// and the password itself is not kept after login.
+//
+// The master key comes from PBKDF2-HMAC-SHA256 over a per-account salt with
+// a tunable iteration count; purpose-specific subkeys are one HMAC of it,
+// and the cipher key used for every file and record is one of them.
+// Files in the SLPP version 1 format are keyed by a plain SHA-256 of the
+// password, which is derived alongside so existing data stays readable.
+// Copies are cheap and may be handed to worker threads.
+class SessionKey {
+public:
+    SessionKey() = default;
+
+    // The expensive step: runs the password KDF once
+    static SessionKey derive(const QString& password, const QByteArray& salt, int iterations);
+    static QByteArray generateSalt();
+
+    // Iteration count for new accounts; existing accounts keep the count
+    // they were created with, which is stored next to their salt
+    static const int DefaultIterations = 200000;
+    static const int SaltSize = 16;
+
+    bool isNull() const { return m_masterKey.isEmpty(); }
+    void clear();
+
+    // Key of the version 1 XOR format
+    const QByteArray& legacyKey() const { return m_legacyKey; }
+    // ChaCha20-Poly1305 key for records, derived once with the session
+    const QByteArray& cipherKey() const { return m_cipherKey; }
+    // Per-file cipher key: one HMAC of the cipher key over the file's salt
+    QByteArray fileKey(const QByteArray& salt) const;
+    // HMAC-SHA256(master key, purpose); cheap enough to call per file
+    QByteArray subkey(const QByteArray& purpose) const;
+    // Hex digest stored in users.dat to check the password at login
+    QString verifier() const;
+
+private:
+    QByteArray m_masterKey;
+    QByteArray m_legacyKey;
+    QByteArray m_cipherKey;
+};
+
+#endif // SESSIONKEY_H
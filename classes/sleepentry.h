@@ -0,0 +1,71 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SLEEPENTRY_H
+#define SLEEPENTRY_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDate>
+#include <QDateTime>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QTime>
+#include <QUuid>
+#include <QVariantMap>
+
+struct SleepEntry {
+    QUuid id;
+    QDateTime timestamp;
+    QDate date;
+    QTime bedtime;
+    QTime waketime;
+    double hours;
+    QString notes;
+    QList<QPair<QString, double>> symptomData;
+
+    SleepEntry() : id(QUuid::createUuid()), hours(0.0) {}
+    SleepEntry(const QUuid &entryId) : id(entryId), hours(0.0) {}
+
+    // Detail record layout written by saveEntry and stored in the pack
+    QByteArray toDetailRecord() const {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_15);
+        out << id << timestamp << date << bedtime << waketime << hours << notes
+            << symptomData;
+        return data;
+    }
+
+    static SleepEntry fromDetailRecord(const QByteArray &data) {
+        SleepEntry entry{QUuid()};
+        QDataStream in(data);
+        in.setVersion(QDataStream::Qt_5_15);
+        in >> entry.id >> entry.timestamp >> entry.date >> entry.bedtime >> entry.waketime
+           >> entry.hours >> entry.notes >> entry.symptomData;
+        return entry;
+    }
+
+    // Helper method to convert to/from QVariantMap for summary data
+    QVariantMap toVariantMap() const {
+        QVariantMap map;
+        map["id"] = id.toString(QUuid::WithoutBraces);
+        map["date"] = date;
+        map["sleep_duration"] = hours;
+
+        for (const auto &pair : symptomData) {
+            map[pair.first] = pair.second;
+        }
+        return map;
+    }
+
+    static SleepEntry fromVariantMap(const QVariantMap &map) {
+        SleepEntry entry(QUuid::fromString(map["id"].toString()));
+        entry.date = map["date"].toDate();
+        entry.hours = map["sleep_duration"].toDouble();
+
+        // Note: symptomData would need to be populated separately
+        return entry;
+    }
+};
+
+#endif // SLEEPENTRY_H
@@ -0,0 +1,286 @@
+//created by drmrsthemonarch with ai effort
+#include "sleeptable.h"
+#include <QPair>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+bool isReservedKey(const QString& key) {
+    return key == "id" || key == "date" || key == "sleep_duration";
+}
+
+int bitmapWords(int rows) {
+    return (rows + 63) / 64;
+}
+
+// Insert a bit at pos into a bitmap currently holding rows bits
+void insertBit(QVector<quint64>& bits, int rows, int pos, bool value) {
+    if (bitmapWords(rows + 1) > bits.size()) {
+        bits.append(0);
+    }
+    quint64* words = bits.data();
+    int word = pos >> 6;
+    int bit = pos & 63;
+    for (int i = bits.size() - 1; i > word; --i) {
+        words[i] = (words[i] << 1) | (words[i - 1] >> 63);
+    }
+    quint64 lowMask = (quint64(1) << bit) - 1;
+    words[word] = (words[word] & lowMask) | ((words[word] & ~lowMask) << 1)
+                | (quint64(value) << bit);
+}
+
+// Remove the bit at pos from a bitmap currently holding rows bits
+void removeBit(QVector<quint64>& bits, int rows, int pos) {
+    quint64* words = bits.data();
+    int count = bits.size();
+    int word = pos >> 6;
+    int bit = pos & 63;
+    quint64 lowMask = (quint64(1) << bit) - 1;
+    words[word] = (words[word] & lowMask) | ((words[word] >> 1) & ~lowMask);
+    for (int i = word + 1; i < count; ++i) {
+        words[i - 1] |= words[i] << 63;
+        words[i] >>= 1;
+    }
+    if (bitmapWords(rows - 1) < count) {
+        bits.removeLast();
+    }
+}
+}
+
+SleepTable SleepTable::fromEntries(const SummaryEntries& entries,
+                                   const QStringList& columnNames) {
+    SleepTable table;
+    for (const QString& name : columnNames) {
+        if (!table.m_columnIndex.contains(name)) {
+            table.m_columnIndex.insert(name, table.m_columnNames.size());
+            table.m_columnNames.append(name);
+        }
+    }
+
+    // Entries still held as snapshot records are read field by field from
+    // the record block; only decoded entries go through their maps
+    const SummaryRecords& records = entries.records();
+    const QStringList& recordNames = records.columnNames();
+
+    // Convert each date once and sort (day, entry) pairs instead of maps
+    QVector<QPair<qint64, int>> order;
+    order.reserve(entries.size());
+    QSet<QString> extraNames;
+    QVector<bool> recordColumnUsed(recordNames.size(), false);
+
+    for (int i = 0; i < entries.size(); ++i) {
+        int source = entries.recordRow(i);
+        if (source >= 0) {
+            if (!records.hasDate(source)) {
+                continue;
+            }
+            order.append(qMakePair(records.day(source), i));
+            for (int c = 0; c < recordNames.size(); ++c) {
+                if (!recordColumnUsed[c] && records.isPresent(source, c)) {
+                    recordColumnUsed[c] = true;
+                }
+            }
+            continue;
+        }
+
+        const QVariantMap& entry = entries.at(i);
+        QDate date = entry.value("date").toDate();
+        if (!date.isValid()) {
+            continue;
+        }
+        order.append(qMakePair(date.toJulianDay(), i));
+
+        for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+            if (!isReservedKey(it.key()) && !table.m_columnIndex.contains(it.key())) {
+                extraNames.insert(it.key());
+            }
+        }
+    }
+    for (int c = 0; c < recordNames.size(); ++c) {
+        if (recordColumnUsed[c] && !table.m_columnIndex.contains(recordNames[c])) {
+            extraNames.insert(recordNames[c]);
+        }
+    }
+
+    // Keep values of symptoms that are no longer defined
+    QStringList extras = extraNames.values();
+    extras.sort();
+    for (const QString& name : extras) {
+        table.m_columnIndex.insert(name, table.m_columnNames.size());
+        table.m_columnNames.append(name);
+    }
+
+    QVector<int> tableColumnOf(recordNames.size());
+    for (int c = 0; c < recordNames.size(); ++c) {
+        tableColumnOf[c] = table.m_columnIndex.value(recordNames[c], -1);
+    }
+
+    // Stable, so entries sharing a night keep the order they were saved in
+    std::stable_sort(order.begin(), order.end(),
+                     [](const QPair<qint64, int>& a, const QPair<qint64, int>& b) {
+                         return a.first < b.first;
+                     });
+
+    table.resizeRows(order.size());
+
+    for (int row = 0; row < order.size(); ++row) {
+        table.m_days[row] = order[row].first;
+        quint64 bit = quint64(1) << (row & 63);
+
+        int source = entries.recordRow(order[row].second);
+        if (source >= 0) {
+            table.m_ids[row] = records.id(source);
+            table.m_sleepDuration[row] =
+                records.hasSleepDuration(source) ? records.sleepDuration(source) : 0.0;
+            for (int c = 0; c < recordNames.size(); ++c) {
+                int column = tableColumnOf[c];
+                if (column >= 0 && records.isPresent(source, c)) {
+                    table.m_columns[column][row] = records.value(source, c);
+                    table.m_presence[column][row >> 6] |= bit;
+                }
+            }
+            continue;
+        }
+
+        const QVariantMap& entry = entries.at(order[row].second);
+        table.m_ids[row] = QUuid::fromString(entry.value("id").toString());
+        table.m_sleepDuration[row] = entry.value("sleep_duration").toDouble();
+
+        for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+            int column = table.m_columnIndex.value(it.key(), -1);
+            if (column < 0) {
+                continue;
+            }
+            // Booleans from older files become 0.0/1.0
+            table.m_columns[column][row] = it.value().toDouble();
+            table.m_presence[column][row >> 6] |= bit;
+        }
+    }
+
+    return table;
+}
+
+SleepTableView SleepTable::all() const {
+    return SleepTableView(*this, 0, rowCount());
+}
+
+SleepTableView SleepTable::range(const QDate& start, const QDate& end) const {
+    const qint64* first = m_days.constData();
+    const qint64* last = first + m_days.size();
+    const qint64* lower = std::lower_bound(first, last, start.toJulianDay());
+    const qint64* upper = std::upper_bound(lower, last, end.toJulianDay());
+    return SleepTableView(*this, int(lower - first), int(upper - first));
+}
+
+int SleepTable::rowOf(const QUuid& id) const {
+    // A 16-byte compare per row; cheaper than keeping a hash in sync with
+    // every insert and removal
+    for (int row = 0; row < m_ids.size(); ++row) {
+        if (m_ids[row] == id) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void SleepTable::upsertRow(const QVariantMap& entry) {
+    QUuid id = QUuid::fromString(entry.value("id").toString());
+    QDate date = entry.value("date").toDate();
+    qint64 day = date.isValid() ? date.toJulianDay() : 0;
+
+    for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+        if (!isReservedKey(it.key()) && !m_columnIndex.contains(it.key())) {
+            addColumn(it.key());
+        }
+    }
+
+    int existing = rowOf(id);
+    if (existing >= 0 && date.isValid() && m_days[existing] == day) {
+        // Same night: overwrite in place so the row keeps its position
+        m_sleepDuration[existing] = entry.value("sleep_duration").toDouble();
+        for (int c = 0; c < columnCount(); ++c) {
+            auto value = entry.constFind(m_columnNames[c]);
+            bool present = value != entry.constEnd();
+            m_columns[c][existing] = present ? value.value().toDouble() : 0.0;
+            quint64 mask = quint64(1) << (existing & 63);
+            if (present) {
+                m_presence[c][existing >> 6] |= mask;
+            } else {
+                m_presence[c][existing >> 6] &= ~mask;
+            }
+        }
+        return;
+    }
+    if (existing >= 0) {
+        removeRowAt(existing);
+    }
+    if (!date.isValid()) {
+        return;
+    }
+
+    // After any rows of the same night, matching the order they were saved in
+    int rows = rowCount();
+    int row = int(std::upper_bound(m_days.constBegin(), m_days.constEnd(), day)
+                  - m_days.constBegin());
+
+    m_days.insert(row, day);
+    m_ids.insert(row, id);
+    m_sleepDuration.insert(row, entry.value("sleep_duration").toDouble());
+
+    for (int c = 0; c < columnCount(); ++c) {
+        auto value = entry.constFind(m_columnNames[c]);
+        bool present = value != entry.constEnd();
+        m_columns[c].insert(row, present ? value.value().toDouble() : 0.0);
+        insertBit(m_presence[c], rows, row, present);
+    }
+}
+
+void SleepTable::removeRow(const QUuid& id) {
+    int row = rowOf(id);
+    if (row >= 0) {
+        removeRowAt(row);
+    }
+}
+
+qint64 SleepTable::memoryFootprint() const {
+    qint64 bytes = m_days.size() * qint64(sizeof(qint64))
+                 + m_ids.size() * qint64(sizeof(QUuid))
+                 + m_sleepDuration.size() * qint64(sizeof(double));
+    for (int c = 0; c < columnCount(); ++c) {
+        bytes += m_columns[c].size() * qint64(sizeof(double));
+        bytes += m_presence[c].size() * qint64(sizeof(quint64));
+    }
+    return bytes;
+}
+
+void SleepTable::resizeRows(int rows) {
+    m_days.resize(rows);
+    m_ids.resize(rows);
+    m_sleepDuration.resize(rows);
+    m_columns.resize(columnCount());
+    m_presence.resize(columnCount());
+    for (int c = 0; c < columnCount(); ++c) {
+        m_columns[c].fill(0.0, rows);
+        m_presence[c].fill(0, bitmapWords(rows));
+    }
+}
+
+int SleepTable::addColumn(const QString& name) {
+    int column = m_columnNames.size();
+    m_columnIndex.insert(name, column);
+    m_columnNames.append(name);
+    m_columns.append(QVector<double>(rowCount(), 0.0));
+    m_presence.append(QVector<quint64>(bitmapWords(rowCount()), 0));
+    return column;
+}
+
+void SleepTable::removeRowAt(int row) {
+    int rows = rowCount();
+    m_days.remove(row);
+    m_ids.remove(row);
+    m_sleepDuration.remove(row);
+    for (int c = 0; c < columnCount(); ++c) {
+        m_columns[c].remove(row);
+        removeBit(m_presence[c], rows, row);
+    }
+}
@@ -0,0 +1,101 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SLEEPTABLE_H
+#define SLEEPTABLE_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+#include <QVector>
+#include "summaryentries.h"
+
+class SleepTableView;
+
+// Columnar, date-sorted view of the summary history.
+// One contiguous double array per symptom (plus sleep duration) replaces the
+// string-keyed QVariantMap lookups in the plot and export paths. Cells that
+// an entry never recorded read as 0.0 and are flagged in a presence bitmap.
+class SleepTable {
+public:
+    SleepTable() = default;
+
+    // Columns follow columnNames; names only found in the data are appended
+    static SleepTable fromEntries(const SummaryEntries& entries,
+                                  const QStringList& columnNames);
+
+    int rowCount() const { return m_days.size(); }
+    int columnCount() const { return m_columnNames.size(); }
+    bool isEmpty() const { return m_days.isEmpty(); }
+
+    const QStringList& columnNames() const { return m_columnNames; }
+    int columnIndex(const QString& name) const { return m_columnIndex.value(name, -1); }
+
+    // Julian day numbers, ascending
+    const qint64* days() const { return m_days.constData(); }
+    QDate date(int row) const { return QDate::fromJulianDay(m_days[row]); }
+    QUuid id(int row) const { return m_ids[row]; }
+
+    const double* sleepDuration() const { return m_sleepDuration.constData(); }
+    const double* column(int column) const { return m_columns[column].constData(); }
+    bool isPresent(int column, int row) const {
+        return (m_presence[column][row >> 6] >> (row & 63)) & 1;
+    }
+
+    // Zero-copy windows; a date range is two binary searches on days()
+    SleepTableView all() const;
+    SleepTableView range(const QDate& start, const QDate& end) const;
+
+    // Incremental maintenance that keeps rows sorted by date
+    int rowOf(const QUuid& id) const;
+    void upsertRow(const QVariantMap& entry);
+    void removeRow(const QUuid& id);
+
+    // Bytes held by the row and column arrays
+    qint64 memoryFootprint() const;
+
+private:
+    void resizeRows(int rows);
+    int addColumn(const QString& name);
+    void removeRowAt(int row);
+
+    QVector<qint64> m_days;
+    QVector<QUuid> m_ids;
+    QVector<double> m_sleepDuration;
+    QStringList m_columnNames;
+    QHash<QString, int> m_columnIndex;
+    QVector<QVector<double>> m_columns;
+    QVector<QVector<quint64>> m_presence;
+};
+
+// Contiguous run of rows [first, last) of a SleepTable, sharing its arrays.
+// Only valid while the table it was taken from is left unchanged.
+class SleepTableView {
+public:
+    SleepTableView(const SleepTable& table, int first, int last)
+        : m_table(&table), m_first(first), m_last(last) {}
+
+    int rowCount() const { return m_last - m_first; }
+    int columnCount() const { return m_table->columnCount(); }
+    bool isEmpty() const { return m_first == m_last; }
+    int firstRow() const { return m_first; }
+
+    const QStringList& columnNames() const { return m_table->columnNames(); }
+    int columnIndex(const QString& name) const { return m_table->columnIndex(name); }
+
+    const qint64* days() const { return m_table->days() + m_first; }
+    QDate date(int row) const { return m_table->date(m_first + row); }
+    QUuid id(int row) const { return m_table->id(m_first + row); }
+
+    const double* sleepDuration() const { return m_table->sleepDuration() + m_first; }
+    const double* column(int column) const { return m_table->column(column) + m_first; }
+    bool isPresent(int column, int row) const { return m_table->isPresent(column, m_first + row); }
+
+private:
+    const SleepTable* m_table;
+    int m_first;
+    int m_last;
+};
+
+#endif // SLEEPTABLE_H
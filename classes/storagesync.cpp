@@ -0,0 +1,126 @@
+//created by drmrsthemonarch with ai effort
+#include "storagesync.h"
+#include <QFile>
+#include <atomic>
+
+#ifdef Q_OS_WIN
+#include <QDir>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::atomic<int> syncPolicy(int(StorageSync::Policy::Commit));
+
+// Innermost open batch of the calling thread
+thread_local StorageBatch* currentBatch = nullptr;
+}
+
+StorageSync::Policy StorageSync::policy() {
+    return Policy(syncPolicy.load());
+}
+
+void StorageSync::setPolicy(Policy policy) {
+    syncPolicy.store(int(policy));
+}
+
+bool StorageSync::appended(QFileDevice& file) {
+    if (!file.flush()) {
+        return false;
+    }
+    if (policy() == Policy::Flush) {
+        return true;
+    }
+    if (currentBatch) {
+        currentBatch->touch(file.fileName());
+        return true;
+    }
+    return syncFile(file);
+}
+
+bool StorageSync::syncFile(QFileDevice& file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    // QFile keeps no CRT descriptor here; the cache is per file, so any
+    // handle flushes what this one wrote
+    return syncPath(file.fileName());
+#else
+    return file.handle() >= 0 && ::fsync(file.handle()) == 0;
+#endif
+}
+
+bool StorageSync::syncPath(const QString& fileName) {
+#ifdef Q_OS_WIN
+    QString native = QDir::toNativeSeparators(fileName);
+    HANDLE handle = CreateFileW(reinterpret_cast<LPCWSTR>(native.utf16()), GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool ok = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return ok;
+#else
+    int fd = ::open(QFile::encodeName(fileName).constData(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+bool StorageSync::syncDirectory(const QString& directory) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(directory);
+    return true;
+#else
+    return syncPath(directory);
+#endif
+}
+
+StorageBatch::StorageBatch() : m_outer(currentBatch), m_committed(false) {
+    currentBatch = this;
+}
+
+StorageBatch::~StorageBatch() {
+    commit();
+}
+
+bool StorageBatch::commit() {
+    if (m_committed) {
+        return true;
+    }
+    m_committed = true;
+    currentBatch = m_outer;
+
+    if (m_outer) {
+        for (const QString& fileName : m_files) {
+            m_outer->touch(fileName);
+        }
+        return true;
+    }
+
+    // Each file once, however many records went into it; a file that was
+    // replaced or removed since has nothing left to sync
+    bool ok = true;
+    for (const QString& fileName : m_files) {
+        if (QFile::exists(fileName)) {
+            ok = StorageSync::syncPath(fileName) && ok;
+        }
+    }
+    m_files.clear();
+    return ok;
+}
+
+void StorageBatch::touch(const QString& fileName) {
+    if (!m_files.contains(fileName)) {
+        m_files.append(fileName);
+    }
+}
@@ -0,0 +1,63 @@
+//created by drmrsthemonarch with ai effort
+#ifndef STORAGESYNC_H
+#define STORAGESYNC_H
+
+#include <QFileDevice>
+#include <QString>
+#include <QStringList>
+
+// When appended records reach the disk.
+//
+// Whole-file rewrites (the summary snapshot, the detail pack and index,
+// users.dat) always go through QSaveFile, which syncs a temporary file and
+// renames it over the target, so a crash leaves the old file or the new
+// one and never a truncated one. Appends (the summary journal and detail
+// pack records) are synced according to the policy below.
+class StorageSync {
+public:
+    enum class Policy {
+        Flush,  // hand appends to the OS only; a power loss may drop recent saves
+        Commit  // fsync every appended file before a save reports success
+    };
+
+    static Policy policy();
+    static void setPolicy(Policy policy);
+
+    // Call after appending to file, while it is still open. Syncs it now, or
+    // leaves it to the StorageBatch open on this thread.
+    static bool appended(QFileDevice& file);
+    // So that a rename into directory survives power loss; no-op on Windows
+    static bool syncDirectory(const QString& directory);
+
+    // fsync regardless of the policy, through the open file or by path
+    static bool syncFile(QFileDevice& file);
+    static bool syncPath(const QString& fileName);
+};
+
+// Group commit for one user action that touches several files, such as a
+// save (detail record, then journal record) or a delete (tombstone, then
+// journal record). While a batch is open, appends are only flushed; commit()
+// then syncs each touched file once, in the order they were first written,
+// so the journal record goes down after the detail record it refers to.
+// Batches nest: an inner batch folds into the outer one.
+class StorageBatch {
+public:
+    StorageBatch();
+    // Commits if commit() was not called
+    ~StorageBatch();
+
+    bool commit();
+
+private:
+    friend class StorageSync;
+    void touch(const QString& fileName);
+
+    StorageBatch* m_outer;
+    QStringList m_files;
+    bool m_committed;
+
+    StorageBatch(const StorageBatch&) = delete;
+    StorageBatch& operator=(const StorageBatch&) = delete;
+};
+
+#endif // STORAGESYNC_H
@@ -0,0 +1,314 @@
+//created by drmrsthemonarch with ai effort
+#include "summarycodec.h"
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QUuid>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace {
+// Header: magic, version, row count, column count (u16), reserved (u16)
+const int HeaderSize = 16;
+
+// Row layout; the presence bits close the row
+const int IdSize = 16;
+const int DayOffset = 16;
+const int SleepOffset = 20;
+const int ValuesOffset = 28;
+
+const int DateBit = 0;
+const int SleepBit = 1;
+const int FirstColumnBit = 2;
+
+const int MaxColumns = 0xFFFF;
+const int BlockBytes = 64 * 1024;
+const qint32 NoDay = std::numeric_limits<qint32>::min();
+
+int maskBytes(int columns) {
+    return (FirstColumnBit + columns + 7) / 8;
+}
+
+int rowSize(int columns) {
+    return ValuesOffset + 8 * columns + maskBytes(columns);
+}
+
+bool isReservedKey(const QString& key) {
+    return key == "id" || key == "date" || key == "sleep_duration";
+}
+
+// Booleans from older files are stored as 0.0/1.0 like everything else
+bool isNumber(const QVariant& value) {
+    switch (value.userType()) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Bool:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isStorableDay(const QDate& date) {
+    qint64 day = date.toJulianDay();
+    return date.isValid() && day > NoDay && day <= std::numeric_limits<qint32>::max();
+}
+
+void putDouble(uchar* out, double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, out);
+}
+
+double getDouble(const uchar* in) {
+    quint64 bits = qFromLittleEndian<quint64>(in);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void setBit(uchar* mask, int bit) {
+    mask[bit >> 3] |= uchar(1 << (bit & 7));
+}
+
+bool testBit(const uchar* mask, int bit) {
+    return (mask[bit >> 3] >> (bit & 7)) & 1;
+}
+
+// Symptom names in the order they first appear
+QStringList dictionaryOf(const QList<QVariantMap>& entries, QHash<QString, int>& columnOf) {
+    QStringList names;
+    for (const QVariantMap& entry : entries) {
+        for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+            if (!isReservedKey(it.key()) && !columnOf.contains(it.key())) {
+                columnOf.insert(it.key(), names.size());
+                names.append(it.key());
+            }
+        }
+    }
+    return names;
+}
+}
+
+bool SummaryCodec::isEncodable(const QList<QVariantMap>& entries) {
+    QSet<QString> names;
+    for (const QVariantMap& entry : entries) {
+        if (QUuid::fromString(entry.value("id").toString()).isNull()) {
+            return false;
+        }
+        for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+            const QString& key = it.key();
+            if (key == "id") {
+                continue;
+            }
+            if (key == "date") {
+                if (!isStorableDay(it.value().toDate())) {
+                    return false;
+                }
+                continue;
+            }
+            if (!isNumber(it.value())) {
+                return false;
+            }
+            if (key != "sleep_duration" && !names.contains(key)) {
+                names.insert(key);
+                if (names.size() > MaxColumns || key.toUtf8().size() > 0xFFFF) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool SummaryCodec::isEncoded(QIODevice& device) {
+    QByteArray head = device.peek(4);
+    return head.size() == 4 && qFromLittleEndian<quint32>(head.constData()) == Magic;
+}
+
+bool SummaryCodec::write(QIODevice& device, const QList<QVariantMap>& entries) {
+    QHash<QString, int> columnOf;
+    QStringList names = dictionaryOf(entries, columnOf);
+    int columns = names.size();
+
+    QByteArray header(HeaderSize, '\0');
+    uchar* fields = reinterpret_cast<uchar*>(header.data());
+    qToLittleEndian(Magic, fields);
+    qToLittleEndian(Version, fields + 4);
+    qToLittleEndian(quint32(entries.size()), fields + 8);
+    qToLittleEndian(quint16(columns), fields + 12);
+    for (const QString& name : names) {
+        QByteArray utf8 = name.toUtf8();
+        uchar length[2];
+        qToLittleEndian(quint16(utf8.size()), length);
+        header.append(reinterpret_cast<const char*>(length), 2);
+        header.append(utf8);
+    }
+    if (device.write(header) != header.size()) {
+        return false;
+    }
+
+    // Rows are laid out a block at a time and written in one call each
+    int stride = rowSize(columns);
+    int mask = stride - maskBytes(columns);
+    int blockRows = qMax(1, BlockBytes / stride);
+    QByteArray block;
+
+    for (int first = 0; first < entries.size(); first += blockRows) {
+        int rows = qMin(blockRows, entries.size() - first);
+        block.fill('\0', rows * stride);
+        uchar* row = reinterpret_cast<uchar*>(block.data());
+
+        for (int i = first; i < first + rows; ++i, row += stride) {
+            const QVariantMap& entry = entries[i];
+            qint32 day = NoDay;
+            for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+                const QString& key = it.key();
+                if (key == "id") {
+                    QByteArray id = QUuid::fromString(it.value().toString()).toRfc4122();
+                    std::memcpy(row, id.constData(), IdSize);
+                } else if (key == "date") {
+                    day = qint32(it.value().toDate().toJulianDay());
+                    setBit(row + mask, DateBit);
+                } else if (key == "sleep_duration") {
+                    putDouble(row + SleepOffset, it.value().toDouble());
+                    setBit(row + mask, SleepBit);
+                } else {
+                    int column = columnOf.value(key);
+                    putDouble(row + ValuesOffset + 8 * column, it.value().toDouble());
+                    setBit(row + mask, FirstColumnBit + column);
+                }
+            }
+            qToLittleEndian(day, row + DayOffset);
+        }
+
+        if (device.write(block) != block.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SummaryCodec::read(QIODevice& device, SummaryRecords& records) {
+    records = SummaryRecords();
+
+    uchar header[HeaderSize];
+    if (device.read(reinterpret_cast<char*>(header), HeaderSize) != HeaderSize
+        || qFromLittleEndian<quint32>(header) != Magic
+        || qFromLittleEndian<quint32>(header + 4) != Version) {
+        return false;
+    }
+    quint32 rows = qFromLittleEndian<quint32>(header + 8);
+    int columns = qFromLittleEndian<quint16>(header + 12);
+
+    QStringList names;
+    names.reserve(columns);
+    for (int column = 0; column < columns; ++column) {
+        uchar length[2];
+        if (device.read(reinterpret_cast<char*>(length), 2) != 2) {
+            return false;
+        }
+        int size = qFromLittleEndian<quint16>(length);
+        QByteArray utf8 = device.read(size);
+        if (utf8.size() != size) {
+            return false;
+        }
+        names.append(QString::fromUtf8(utf8));
+    }
+
+    int stride = rowSize(columns);
+    if (rows > quint32(std::numeric_limits<int>::max() / stride)) {
+        return false;
+    }
+
+    // Grown a block at a time, so the count is only trusted as far as the
+    // rows actually read
+    QByteArray block;
+    qint64 total = qint64(rows) * stride;
+    qint64 blockSize = qMax(1, BlockBytes / stride) * qint64(stride);
+    while (block.size() < total) {
+        int done = block.size();
+        int size = int(qMin(blockSize, total - done));
+        block.resize(done + size);
+        if (device.read(block.data() + done, size) != size) {
+            return false;
+        }
+    }
+
+    records.m_block = block;
+    records.m_names = names;
+    records.m_rows = int(rows);
+    records.m_stride = stride;
+    records.m_mask = stride - maskBytes(columns);
+    return true;
+}
+
+bool SummaryCodec::read(QIODevice& device, QList<QVariantMap>& entries) {
+    entries.clear();
+    SummaryRecords records;
+    if (!read(device, records)) {
+        return false;
+    }
+    entries.reserve(records.size());
+    for (int row = 0; row < records.size(); ++row) {
+        entries.append(records.entry(row));
+    }
+    return true;
+}
+
+const uchar* SummaryRecords::rowAt(int row) const {
+    return reinterpret_cast<const uchar*>(m_block.constData()) + qint64(row) * m_stride;
+}
+
+QUuid SummaryRecords::id(int row) const {
+    return QUuid::fromRfc4122(
+        QByteArray::fromRawData(reinterpret_cast<const char*>(rowAt(row)), IdSize));
+}
+
+bool SummaryRecords::hasDate(int row) const {
+    return testBit(rowAt(row) + m_mask, DateBit);
+}
+
+qint64 SummaryRecords::day(int row) const {
+    return qFromLittleEndian<qint32>(rowAt(row) + DayOffset);
+}
+
+bool SummaryRecords::hasSleepDuration(int row) const {
+    return testBit(rowAt(row) + m_mask, SleepBit);
+}
+
+double SummaryRecords::sleepDuration(int row) const {
+    return getDouble(rowAt(row) + SleepOffset);
+}
+
+bool SummaryRecords::isPresent(int row, int column) const {
+    return testBit(rowAt(row) + m_mask, FirstColumnBit + column);
+}
+
+double SummaryRecords::value(int row, int column) const {
+    return getDouble(rowAt(row) + ValuesOffset + 8 * column);
+}
+
+QVariantMap SummaryRecords::entry(int row) const {
+    // Column names are shared with every map built from this block
+    QVariantMap entry;
+    entry.insert(QStringLiteral("id"), id(row).toString(QUuid::WithoutBraces));
+    if (hasDate(row)) {
+        entry.insert(QStringLiteral("date"), QDate::fromJulianDay(day(row)));
+    }
+    if (hasSleepDuration(row)) {
+        entry.insert(QStringLiteral("sleep_duration"), sleepDuration(row));
+    }
+    for (int column = 0; column < m_names.size(); ++column) {
+        if (isPresent(row, column)) {
+            entry.insert(m_names[column], value(row, column));
+        }
+    }
+    return entry;
+}
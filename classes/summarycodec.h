@@ -0,0 +1,76 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SUMMARYCODEC_H
+#define SUMMARYCODEC_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+
+// Binary layout of the summary snapshot, replacing a QDataStream'd
+// QList<QVariantMap> that repeated every symptom name as a UTF-16 key and
+// every id as a 36-character string.
+//
+// Little-endian throughout. The header holds a magic, the layout version,
+// the row count and a dictionary of symptom names (UTF-8), which become
+// column numbers. Every row then has the same width:
+//
+//   id (16 bytes, RFC 4122) | day (i32, Julian day) | sleep_duration (f64)
+//   | one f64 per dictionary column | presence bits
+//
+// Presence bit 0 is the date, bit 1 sleep_duration and bit 2 + n column n,
+// so a missing field reads back missing rather than as zero. Reading copies
+// the rows into one block, which is then scanned at a fixed stride.
+class SummaryRecords;
+
+class SummaryCodec {
+public:
+    static const quint32 Magic = 0x534C5052; // "SLPR" (Sleep Records)
+    static const quint32 Version = 1;
+
+    // Every entry has a UUID id, and all other fields are a date,
+    // sleep_duration or a number; anything else is left to the old format
+    static bool isEncodable(const QList<QVariantMap>& entries);
+    // True if the device is positioned at an encoded snapshot; consumes nothing
+    static bool isEncoded(QIODevice& device);
+
+    // write expects isEncodable(entries). Values come back as doubles and
+    // ids as strings without braces.
+    static bool write(QIODevice& device, const QList<QVariantMap>& entries);
+    static bool read(QIODevice& device, SummaryRecords& records);
+    static bool read(QIODevice& device, QList<QVariantMap>& entries);
+};
+
+// Rows of an encoded snapshot, still in their fixed-width form. Fields are
+// read straight out of the row block, and a QVariantMap is only built for
+// a row that is asked for one. Copies share the block.
+class SummaryRecords {
+public:
+    int size() const { return m_rows; }
+    bool isEmpty() const { return m_rows == 0; }
+    const QStringList& columnNames() const { return m_names; }
+
+    QUuid id(int row) const;
+    bool hasDate(int row) const;
+    qint64 day(int row) const; // Julian day
+    bool hasSleepDuration(int row) const;
+    double sleepDuration(int row) const;
+    bool isPresent(int row, int column) const;
+    double value(int row, int column) const;
+
+    QVariantMap entry(int row) const;
+
+private:
+    friend class SummaryCodec;
+    const uchar* rowAt(int row) const;
+
+    QByteArray m_block;
+    QStringList m_names;
+    int m_rows = 0;
+    int m_stride = 0;
+    int m_mask = 0;
+};
+
+#endif // SUMMARYCODEC_H
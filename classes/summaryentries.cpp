@@ -0,0 +1,88 @@
+//created by drmrsthemonarch with ai effort
+#include "summaryentries.h"
+
+SummaryEntries::SummaryEntries(const SummaryRecords& records) : m_records(records) {
+    m_entries.reserve(records.size());
+    m_recordRows.reserve(records.size());
+    m_indexById.reserve(records.size());
+    for (int row = 0; row < records.size(); ++row) {
+        m_indexById.insert(records.id(row).toString(QUuid::WithoutBraces), m_entries.size());
+        m_entries.append(QVariantMap());
+        m_recordRows.append(row);
+    }
+}
+
+SummaryEntries::SummaryEntries(const QList<QVariantMap>& entries) {
+    m_entries.reserve(entries.size());
+    m_recordRows.reserve(entries.size());
+    m_indexById.reserve(entries.size());
+    for (const QVariantMap& entry : entries) {
+        append(entry);
+    }
+}
+
+const QVariantMap& SummaryEntries::at(int index) const {
+    int row = m_recordRows[index];
+    if (row >= 0) {
+        m_entries[index] = m_records.entry(row);
+        m_recordRows[index] = -1;
+    }
+    return m_entries[index];
+}
+
+QList<QVariantMap> SummaryEntries::toList() const {
+    for (int i = 0; i < m_entries.size(); ++i) {
+        at(i);
+    }
+    return m_entries;
+}
+
+bool SummaryEntries::upsert(const QVariantMap& entry) {
+    int index = indexOf(entry.value("id").toString());
+    if (index < 0) {
+        append(entry);
+        return true;
+    }
+    m_entries[index] = entry;
+    m_recordRows[index] = -1;
+    return false;
+}
+
+bool SummaryEntries::merge(const QVariantMap& changes) {
+    int index = indexOf(changes.value("id").toString());
+    if (index < 0) {
+        append(changes);
+        return true;
+    }
+    at(index);
+    QVariantMap& target = m_entries[index];
+    for (auto field = changes.constBegin(); field != changes.constEnd(); ++field) {
+        target.insert(field.key(), field.value());
+    }
+    return false;
+}
+
+bool SummaryEntries::remove(const QString& id) {
+    auto it = m_indexById.find(id);
+    if (it == m_indexById.end()) {
+        return false;
+    }
+    int index = it.value();
+    m_indexById.erase(it);
+    m_entries.removeAt(index);
+    m_recordRows.remove(index);
+
+    // Shift the later entries down instead of rehashing every id
+    for (auto later = m_indexById.begin(); later != m_indexById.end(); ++later) {
+        if (later.value() > index) {
+            --later.value();
+        }
+    }
+    return true;
+}
+
+void SummaryEntries::append(const QVariantMap& entry) {
+    m_indexById.insert(entry.value("id").toString(), m_entries.size());
+    m_entries.append(entry);
+    m_recordRows.append(-1);
+}
@@ -0,0 +1,50 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SUMMARYENTRIES_H
+#define SUMMARYENTRIES_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+#include "summarycodec.h"
+
+// The summary history in saved order. Entries loaded from a binary snapshot
+// stay rows of its record block until something asks for one as a map, so
+// opening a long history builds the id index and nothing per field; edits
+// and journal replay go through the same upsert/merge/remove below.
+class SummaryEntries {
+public:
+    SummaryEntries() = default;
+    explicit SummaryEntries(const SummaryRecords& records);
+    explicit SummaryEntries(const QList<QVariantMap>& entries);
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int indexOf(const QString& id) const { return m_indexById.value(id, -1); }
+    bool contains(const QString& id) const { return m_indexById.contains(id); }
+
+    // Decodes the entry on first access
+    const QVariantMap& at(int index) const;
+    QList<QVariantMap> toList() const;
+
+    // Snapshot row behind an entry not decoded yet, or -1
+    const SummaryRecords& records() const { return m_records; }
+    int recordRow(int index) const { return m_recordRows[index]; }
+
+    // Same semantics as the journal operations; true if the entry was added
+    bool upsert(const QVariantMap& entry);
+    bool merge(const QVariantMap& changes);
+    // True if there was an entry with this id
+    bool remove(const QString& id);
+
+private:
+    void append(const QVariantMap& entry);
+
+    SummaryRecords m_records;
+    mutable QList<QVariantMap> m_entries;
+    mutable QVector<int> m_recordRows;
+    QHash<QString, int> m_indexById;
+};
+
+#endif // SUMMARYENTRIES_H
@@ -0,0 +1,178 @@
+//created by drmrsthemonarch with ai effort
+#include "summaryjournal.h"
+#include "dataencryption.h"
+#include "encrypteddevice.h"
+#include "storagesync.h"
+#include "summarycodec.h"
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+const quint32 JournalMagic = 0x534C504A; // "SLPJ" (Sleep Journal)
+const quint32 LegacyJournalVersion = 1; // records XORed with the legacy key
+const quint32 JournalVersion = 2;       // records sealed with ChaCha20-Poly1305
+
+QString entryIdOf(const QVariantMap& entry) {
+    return entry.value("id").toString();
+}
+}
+
+QString SummaryJournal::journalFileFor(const QString& snapshotFile) {
+    QFileInfo info(snapshotFile);
+    return info.path() + "/" + info.completeBaseName() + ".journal";
+}
+
+bool SummaryJournal::append(const QString& journalFile, Operation op,
+                            const QVariantMap& entry, const SessionKey& key) {
+    QFile file(journalFile);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+
+    // A fresh journal starts with its own header. An older journal is
+    // folded into the snapshot on open, so records are never mixed.
+    if (file.size() == 0) {
+        out << JournalMagic << JournalVersion;
+    } else {
+        quint32 magic, version;
+        out >> magic >> version;
+        if (out.status() != QDataStream::Ok || magic != JournalMagic
+            || version != JournalVersion || !file.seek(file.size())) {
+            file.close();
+            return false;
+        }
+    }
+
+    QByteArray record;
+    QDataStream recordOut(&record, QIODevice::WriteOnly);
+    recordOut.setVersion(QDataStream::Qt_5_15);
+    recordOut << static_cast<quint8>(op) << entry;
+
+    // Each record is encrypted on its own so it can be appended blindly
+    QByteArray encrypted = DataEncryption::encrypt(record, key);
+    out << quint32(encrypted.size());
+    out.writeRawData(encrypted.constData(), encrypted.size());
+
+    // Synced now, or with the rest of the save when a StorageBatch is open
+    bool ok = out.status() == QDataStream::Ok && StorageSync::appended(file);
+    file.close();
+    return ok;
+}
+
+int SummaryJournal::replay(const QString& journalFile, SummaryEntries& entries,
+                           const SessionKey& key, bool* legacyFormat, bool* damagedTail) {
+    if (legacyFormat) {
+        *legacyFormat = false;
+    }
+    if (damagedTail) {
+        *damagedTail = false;
+    }
+
+    QFile file(journalFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != JournalMagic || (version != JournalVersion && version != LegacyJournalVersion)) {
+        file.close();
+        return 0;
+    }
+    bool legacy = version == LegacyJournalVersion;
+    if (legacyFormat) {
+        *legacyFormat = legacy;
+    }
+
+    int replayed = 0;
+    // End of the last record that replayed; anything after it is damage,
+    // even a length prefix cut short
+    qint64 replayedTo = file.pos();
+
+    while (!in.atEnd()) {
+        quint32 length;
+        in >> length;
+        // A torn tail from an interrupted append is simply ignored
+        if (in.status() != QDataStream::Ok || length > file.bytesAvailable()) {
+            break;
+        }
+
+        QByteArray record(int(length), Qt::Uninitialized);
+        if (in.readRawData(record.data(), int(length)) != int(length)) {
+            break;
+        }
+
+        // A record that fails authentication ends the replay like a torn tail
+        if (legacy) {
+            DataEncryption::decryptLegacyInPlace(record, key);
+        } else if (!DataEncryption::decryptInPlace(record, key)) {
+            break;
+        }
+        QDataStream recordIn(&record, QIODevice::ReadOnly);
+        recordIn.setVersion(QDataStream::Qt_5_15);
+
+        quint8 op;
+        QVariantMap entry;
+        recordIn >> op >> entry;
+        if (recordIn.status() != QDataStream::Ok) {
+            break;
+        }
+
+        switch (static_cast<Operation>(op)) {
+        case Operation::Upsert:
+            entries.upsert(entry);
+            break;
+        case Operation::Merge:
+            entries.merge(entry);
+            break;
+        case Operation::Remove:
+            entries.remove(entryIdOf(entry));
+            break;
+        }
+
+        ++replayed;
+        replayedTo = file.pos();
+    }
+
+    if (damagedTail) {
+        *damagedTail = replayedTo < file.size();
+    }
+    file.close();
+    return replayed;
+}
+
+bool SummaryJournal::compact(const QString& snapshotFile, const QString& journalFile,
+                             const QList<QVariantMap>& entries, const SessionKey& key) {
+    // Serialized straight through the encrypting device, a block at a time.
+    // Entries the binary layout cannot hold keep the QVariantMap stream.
+    EncryptedDevice device(snapshotFile, key);
+    if (!device.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    bool written;
+    if (SummaryCodec::isEncodable(entries)) {
+        written = SummaryCodec::write(device, entries);
+    } else {
+        QDataStream out(&device);
+        out.setVersion(QDataStream::Qt_5_15);
+        out << entries;
+        written = out.status() == QDataStream::Ok;
+    }
+    device.close();
+
+    if (!written || !device.isOk()) {
+        return false;
+    }
+
+    // Replaying Upsert/Merge/Remove over the new snapshot is idempotent, so a
+    // crash before this point only costs a redundant replay next time
+    return !QFile::exists(journalFile) || QFile::remove(journalFile);
+}
@@ -0,0 +1,49 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SUMMARYJOURNAL_H
+#define SUMMARYJOURNAL_H
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include "sessionkey.h"
+#include "summaryentries.h"
+
+// Append-only companion to the summary snapshot (symptom_history.dat).
+// Every save, edit or delete appends one encrypted, length-framed record
+// instead of rewriting the whole history. Loading replays the journal on
+// top of the snapshot; compaction folds it back into a fresh snapshot.
+class SummaryJournal {
+public:
+    enum class Operation : quint8 {
+        Upsert = 1, // Replace the entry with this id, or append it
+        Merge = 2,  // Overwrite only the given fields (insert if missing)
+        Remove = 3  // Drop the entry with this id
+    };
+
+    // Replay once this many records have piled up on top of the snapshot
+    static const int CompactionThreshold = 256;
+
+    static QString journalFileFor(const QString& snapshotFile);
+
+    // Append a single record; cost is independent of the history size.
+    // Durable on return under StorageSync's policy, or at the batch commit.
+    static bool append(const QString& journalFile, Operation op,
+                       const QVariantMap& entry, const SessionKey& key);
+
+    // Apply every complete record in the journal to entries.
+    // Returns the number of records replayed. legacyFormat is set for a
+    // journal from before sealed records, which must be compacted before
+    // anything is appended to it. damagedTail is set when the replay stopped
+    // at a torn or unauthenticated record before the end of the file; the
+    // journal must then be compacted too, or later appends would land behind
+    // that record and never be replayed.
+    static int replay(const QString& journalFile, SummaryEntries& entries,
+                      const SessionKey& key, bool* legacyFormat = nullptr,
+                      bool* damagedTail = nullptr);
+
+    // Write entries as the new snapshot and discard the journal
+    static bool compact(const QString& snapshotFile, const QString& journalFile,
+                        const QList<QVariantMap>& entries, const SessionKey& key);
+};
+
+#endif // SUMMARYJOURNAL_H
@@ -0,0 +1,238 @@
+//created by drmrsthemonarch with ai effort
+#include "summarystatistics.h"
+#include "sleeptable.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+const QString SleepDuration = "sleep_duration";
+
+bool isSymptomKey(const QString& key) {
+    return key != "id" && key != "date" && key != SleepDuration;
+}
+}
+
+ValueDistribution::ValueDistribution() {
+    const double quartiles[3] = {0.25, 0.5, 0.75};
+    for (int i = 0; i < 3; ++i) {
+        m_cursors[i].p = quartiles[i];
+        m_cursors[i].value = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+void ValueDistribution::add(double x) {
+    // A new value goes after its equal copies, so only a smaller one moves
+    // the value under a cursor up a rank
+    qint64& copies = m_counts[x];
+    ++copies;
+    ++m_count;
+    for (Cursor& cursor : m_cursors) {
+        if (m_count == 1) {
+            cursor.key = x;
+            cursor.copy = 0;
+            cursor.rank = 0;
+        } else if (x < cursor.key) {
+            ++cursor.rank;
+        }
+        settle(cursor);
+    }
+}
+
+void ValueDistribution::remove(double x) {
+    auto it = m_counts.find(x);
+    if (it == m_counts.end()) {
+        return;
+    }
+    // The last copy of a value is the one taken out
+    qint64 left = --it.value();
+    if (left == 0) {
+        m_counts.erase(it);
+    }
+    --m_count;
+
+    for (Cursor& cursor : m_cursors) {
+        if (m_count == 0) {
+            cursor.value = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        if (x < cursor.key) {
+            --cursor.rank;
+        } else if (x == cursor.key && cursor.copy >= left) {
+            // The value under the cursor went; land on the one before it,
+            // or on the one after when it was the smallest
+            auto next = m_counts.lowerBound(x);
+            if (left > 0) {
+                cursor.copy = left - 1;
+                --cursor.rank;
+            } else if (next != m_counts.begin()) {
+                --next;
+                cursor.key = next.key();
+                cursor.copy = next.value() - 1;
+                --cursor.rank;
+            } else {
+                cursor.key = next.key();
+                cursor.copy = 0;
+            }
+        }
+        settle(cursor);
+    }
+}
+
+void ValueDistribution::stepUp(Cursor& cursor) const {
+    if (cursor.copy + 1 < m_counts.value(cursor.key)) {
+        ++cursor.copy;
+    } else {
+        cursor.key = m_counts.upperBound(cursor.key).key();
+        cursor.copy = 0;
+    }
+    ++cursor.rank;
+}
+
+void ValueDistribution::stepDown(Cursor& cursor) const {
+    if (cursor.copy > 0) {
+        --cursor.copy;
+    } else {
+        auto previous = m_counts.lowerBound(cursor.key);
+        --previous;
+        cursor.key = previous.key();
+        cursor.copy = previous.value() - 1;
+    }
+    --cursor.rank;
+}
+
+void ValueDistribution::settle(Cursor& cursor) const {
+    // Same definition as interpolating over a sorted array
+    double rank = cursor.p * double(m_count - 1);
+    qint64 below = qint64(rank);
+    while (cursor.rank < below) {
+        stepUp(cursor);
+    }
+    while (cursor.rank > below) {
+        stepDown(cursor);
+    }
+
+    double above = cursor.key;
+    if (below + 1 < m_count && cursor.copy + 1 >= m_counts.value(cursor.key)) {
+        above = m_counts.upperBound(cursor.key).key();
+    }
+    cursor.value = cursor.key + (rank - below) * (above - cursor.key);
+}
+
+double ValueDistribution::min() const {
+    return m_counts.isEmpty() ? std::numeric_limits<double>::quiet_NaN() : m_counts.firstKey();
+}
+
+double ValueDistribution::max() const {
+    return m_counts.isEmpty() ? std::numeric_limits<double>::quiet_NaN() : m_counts.lastKey();
+}
+
+void ColumnStatistics::add(double x) {
+    if (count == 0) {
+        min = max = x;
+    } else {
+        min = qMin(min, x);
+        max = qMax(max, x);
+    }
+    ++count;
+    double delta = x - mean;
+    mean += delta / double(count);
+    m2 += delta * (x - mean);
+    values.add(x);
+}
+
+void ColumnStatistics::remove(double x) {
+    if (count <= 1) {
+        *this = ColumnStatistics();
+        return;
+    }
+    // Welford run backwards
+    double previousMean = (double(count) * mean - x) / double(count - 1);
+    m2 = qMax(0.0, m2 - (x - mean) * (x - previousMean));
+    mean = previousMean;
+    --count;
+
+    values.remove(x);
+    min = values.min();
+    max = values.max();
+}
+
+double ColumnStatistics::standardDeviation() const {
+    return std::sqrt(variance());
+}
+
+SummaryStatistics SummaryStatistics::fromTable(const SleepTable& table) {
+    SummaryStatistics statistics;
+    statistics.columnFor(SleepDuration) = fromColumn(table, SleepDuration);
+    for (const QString& name : table.columnNames()) {
+        ColumnStatistics column = fromColumn(table, name);
+        if (column.count > 0) {
+            statistics.columnFor(name) = column;
+        }
+    }
+    return statistics;
+}
+
+ColumnStatistics SummaryStatistics::fromColumn(const SleepTable& table, const QString& name) {
+    ColumnStatistics statistics;
+    if (name == SleepDuration) {
+        const double* values = table.sleepDuration();
+        for (int row = 0; row < table.rowCount(); ++row) {
+            statistics.add(values[row]);
+        }
+        return statistics;
+    }
+
+    int column = table.columnIndex(name);
+    if (column < 0) {
+        return statistics;
+    }
+    const double* values = table.column(column);
+    for (int row = 0; row < table.rowCount(); ++row) {
+        if (table.isPresent(column, row)) {
+            statistics.add(values[row]);
+        }
+    }
+    return statistics;
+}
+
+void SummaryStatistics::add(const QVariantMap& entry) {
+    // Undated entries have no row in the table
+    if (!entry.value("date").toDate().isValid()) {
+        return;
+    }
+    // Missing durations count as 0, as in the table
+    columnFor(SleepDuration).add(entry.value(SleepDuration).toDouble());
+    for (auto field = entry.constBegin(); field != entry.constEnd(); ++field) {
+        if (isSymptomKey(field.key())) {
+            columnFor(field.key()).add(field.value().toDouble());
+        }
+    }
+}
+
+void SummaryStatistics::remove(const QVariantMap& entry) {
+    if (!entry.value("date").toDate().isValid()) {
+        return;
+    }
+    columnFor(SleepDuration).remove(entry.value(SleepDuration).toDouble());
+    for (auto field = entry.constBegin(); field != entry.constEnd(); ++field) {
+        if (isSymptomKey(field.key())) {
+            columnFor(field.key()).remove(field.value().toDouble());
+        }
+    }
+}
+
+const ColumnStatistics* SummaryStatistics::column(const QString& name) const {
+    int index = m_index.value(name, -1);
+    return index >= 0 && m_columns[index].count > 0 ? &m_columns[index] : nullptr;
+}
+
+ColumnStatistics& SummaryStatistics::columnFor(const QString& name) {
+    auto it = m_index.constFind(name);
+    if (it != m_index.constEnd()) {
+        return m_columns[it.value()];
+    }
+    m_index.insert(name, m_columns.size());
+    m_names.append(name);
+    m_columns.append(ColumnStatistics());
+    return m_columns.last();
+}
@@ -0,0 +1,100 @@
+//created by drmrsthemonarch with ai effort
+#ifndef SUMMARYSTATISTICS_H
+#define SUMMARYSTATISTICS_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+class SleepTable;
+
+// Every value of one column with its multiplicity, in order, so a value
+// comes out as exactly as it went in. The quartiles are kept as cursors on
+// the values at their ranks; an add or remove moves each cursor by at most
+// one rank, so every update is a few map lookups (O(log d) in the number d
+// of distinct values) and reading a quartile is free.
+class ValueDistribution {
+public:
+    ValueDistribution();
+
+    void add(double x);
+    void remove(double x);
+
+    qint64 count() const { return m_count; }
+    // NaN when empty
+    double min() const;
+    double max() const;
+    // Interpolated between the two nearest ranks, like a sorted array
+    double lowerQuartile() const { return m_cursors[0].value; }
+    double median() const { return m_cursors[1].value; }
+    double upperQuartile() const { return m_cursors[2].value; }
+
+private:
+    // Rank `rank` of the sorted values, as a key and which of its copies;
+    // value caches the interpolated quantile at p
+    struct Cursor {
+        double p = 0.0;
+        double key = 0.0;
+        qint64 copy = 0;
+        qint64 rank = 0;
+        double value = 0.0;
+    };
+
+    void stepUp(Cursor& cursor) const;
+    void stepDown(Cursor& cursor) const;
+    void settle(Cursor& cursor) const;
+
+    QMap<double, qint64> m_counts;
+    qint64 m_count = 0;
+    Cursor m_cursors[3];
+};
+
+// Descriptive statistics of one column. Count, mean and variance follow
+// adds and removes exactly (Welford); extremes and quartiles come from the
+// column's value distribution, which follows both just as exactly.
+struct ColumnStatistics {
+    qint64 count = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // sum of squared deviations from the mean
+    double min = 0.0;
+    double max = 0.0;
+    ValueDistribution values;
+
+    void add(double x);
+    void remove(double x);
+    // Sample variance; 0 below two values
+    double variance() const { return count > 1 ? m2 / double(count - 1) : 0.0; }
+    double standardDeviation() const;
+    double lowerQuartile() const { return values.lowerQuartile(); }
+    double median() const { return values.median(); }
+    double upperQuartile() const { return values.upperQuartile(); }
+};
+
+// Statistics for sleep_duration and every symptom column of the summary
+// history. EntryStore keeps them current: each save, edit or delete is one
+// remove and/or one add per field, so no edit ever rescans the history.
+class SummaryStatistics {
+public:
+    static SummaryStatistics fromTable(const SleepTable& table);
+
+    void add(const QVariantMap& entry);
+    void remove(const QVariantMap& entry);
+
+    // Columns in the order they were first seen, sleep_duration first
+    const QStringList& columnNames() const { return m_names; }
+    // Null if no entry has this field
+    const ColumnStatistics* column(const QString& name) const;
+
+private:
+    ColumnStatistics& columnFor(const QString& name);
+    static ColumnStatistics fromColumn(const SleepTable& table, const QString& name);
+
+    QStringList m_names;
+    QHash<QString, int> m_index;
+    QVector<ColumnStatistics> m_columns;
+};
+
+#endif // SUMMARYSTATISTICS_H
@@ -4,17 +4,21 @@
 #include <QStringList>
 
 User::User()
-    : m_createdDate(QDateTime::currentDateTime()) {
+    : m_createdDate(QDateTime::currentDateTime()), m_keyIterations(0) {
 }
 
 User::User(const QString& username, const QString& passwordHash, const QString& displayName)
     : m_username(username), m_passwordHash(passwordHash), 
       m_displayName(displayName.isEmpty() ? username : displayName),
-      m_createdDate(QDateTime::currentDateTime()) {
+      m_createdDate(QDateTime::currentDateTime()), m_keyIterations(0) {
 }
 
 bool User::verifyPassword(const QString& password) const {
-    return hashPassword(password) == m_passwordHash;
+    return !hasKeySalt() && hashPassword(password) == m_passwordHash;
+}
+
+bool User::verifySessionKey(const SessionKey& key) const {
+    return hasKeySalt() && !key.isNull() && key.verifier() == m_passwordHash;
 }
 
 QString User::hashPassword(const QString& password) {
@@ -26,13 +30,15 @@ QString User::hashPassword(const QString& password) {
 }
 
 QString User::serialize() const {
-    // Format: username|passwordHash|displayName|createdDate|lastLogin
-    return QString("%1|%2|%3|%4|%5")
+    // Format: username|passwordHash|displayName|createdDate|lastLogin|keySalt|keyIterations
+    return QString("%1|%2|%3|%4|%5|%6|%7")
         .arg(m_username)
         .arg(m_passwordHash)
         .arg(m_displayName)
         .arg(m_createdDate.toString(Qt::ISODate))
-        .arg(m_lastLogin.toString(Qt::ISODate));
+        .arg(m_lastLogin.toString(Qt::ISODate))
+        .arg(QString(m_keySalt.toHex()))
+        .arg(m_keyIterations);
 }
 
 User User::deserialize(const QString& str) {
@@ -49,6 +55,10 @@ User User::deserialize(const QString& str) {
         if (parts.size() >= 5 && !parts[4].isEmpty()) {
             user.m_lastLogin = QDateTime::fromString(parts[4], Qt::ISODate);
         }
+        if (parts.size() >= 7) {
+            user.m_keySalt = QByteArray::fromHex(parts[5].toLatin1());
+            user.m_keyIterations = parts[6].toInt();
+        }
         
         return user;
     }
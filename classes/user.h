@@ -2,6 +2,7 @@
 #ifndef USER_H
 #define USER_H
 #include <QDateTime>
+#include "sessionkey.h"
 
 class User {
 public:
@@ -13,15 +14,26 @@ public:
     QString getDisplayName() const { return m_displayName; }
     QDateTime getCreatedDate() const { return m_createdDate; }
     QDateTime getLastLogin() const { return m_lastLogin; }
-    QString getEncryptionPassword() const { return m_encryptionPassword; }
+    QByteArray getKeySalt() const { return m_keySalt; }
+    int getKeyIterations() const { return m_keyIterations; }
+    // Accounts created before the salted KDF only have a plain SHA-256 hash
+    bool hasKeySalt() const { return !m_keySalt.isEmpty() && m_keyIterations > 0; }
+    const SessionKey& getSessionKey() const { return m_sessionKey; }
 
     void setUsername(const QString& username) { m_username = username; }
     void setPasswordHash(const QString& hash) { m_passwordHash = hash; }
     void setDisplayName(const QString& name) { m_displayName = name; }
     void setLastLogin(const QDateTime& dt) { m_lastLogin = dt; }
-    void setEncryptionPassword(const QString& pwd) { m_encryptionPassword = pwd; }
+    void setKeyDerivation(const QByteArray& salt, int iterations) {
+        m_keySalt = salt;
+        m_keyIterations = iterations;
+    }
+    void setSessionKey(const SessionKey& key) { m_sessionKey = key; }
 
+    // Unsalted check for accounts without a key salt
     bool verifyPassword(const QString& password) const;
+    // Check for salted accounts; the key is derived by the caller
+    bool verifySessionKey(const SessionKey& key) const;
 
     // Serialization
     QString serialize() const;
@@ -36,7 +48,9 @@ private:
     QString m_displayName;
     QDateTime m_createdDate;
     QDateTime m_lastLogin;
-    QString m_encryptionPassword; // Stored in memory during session for data encryption
+    QByteArray m_keySalt;
+    int m_keyIterations;
+    SessionKey m_sessionKey; // Held in memory during the session for data encryption
 };
 
 #endif // USER_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "usermanager.h"
 #include <QTextStream>
 #include <QDir>
+#include <QSaveFile>
 #include "datapathmanager.h"
 
 UserManager::UserManager()
@@ -43,13 +44,16 @@ void UserManager::loadUsers() {
 }
 
 void UserManager::saveUsers() {
-    QFile file(getUsersFilePath());
+    // Replaces users.dat in one rename, so a crash mid-save cannot lose
+    // every account
+    QSaveFile file(getUsersFilePath());
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QTextStream out(&file);
         for (const User& user : m_users) {
             out << user.serialize() << "\n";
         }
-        file.close();
+        out.flush();
+        file.commit();
     }
 }
 
@@ -64,8 +68,8 @@ bool UserManager::createUser(const QString& username, const QString& password, c
     }
     
     // Create new user
-    QString passwordHash = User::hashPassword(password);
-    User newUser(username, passwordHash, displayName);
+    User newUser(username, QString(), displayName);
+    assignNewKey(newUser, password);
     m_users.append(newUser);
     saveUsers();
     
@@ -75,26 +79,46 @@ bool UserManager::createUser(const QString& username, const QString& password, c
 bool UserManager::authenticateUser(const QString& username, const QString& password) {
     for (User& user : m_users) {
         if (user.getUsername() == username) {
-            if (user.verifyPassword(password)) {
-                // Update last login
-                user.setLastLogin(QDateTime::currentDateTime());
-                saveUsers();
-                
-                // Set as current user
-                delete m_currentUser;
-                m_currentUser = new User(user);
-                // Store the actual password for data encryption (in memory only)
-                m_currentUser->setEncryptionPassword(password);
-
-                emit userLoggedIn(username);
-                return true;
+            SessionKey key;
+            if (user.hasKeySalt()) {
+                // The one expensive derivation of the session
+                key = SessionKey::derive(password, user.getKeySalt(), user.getKeyIterations());
+                if (!user.verifySessionKey(key)) {
+                    return false;
+                }
+            } else {
+                // Older account with an unsalted hash: check it, then move
+                // the account onto the salted KDF
+                if (!user.verifyPassword(password)) {
+                    return false;
+                }
+                key = assignNewKey(user, password);
             }
-            return false;
+
+            // Update last login
+            user.setLastLogin(QDateTime::currentDateTime());
+            saveUsers();
+
+            // Set as current user; only the derived key outlives this call
+            delete m_currentUser;
+            m_currentUser = new User(user);
+            m_currentUser->setSessionKey(key);
+
+            emit userLoggedIn(username);
+            return true;
         }
     }
     return false;
 }
 
+SessionKey UserManager::assignNewKey(User& user, const QString& password) {
+    QByteArray salt = SessionKey::generateSalt();
+    SessionKey key = SessionKey::derive(password, salt, SessionKey::DefaultIterations);
+    user.setKeyDerivation(salt, SessionKey::DefaultIterations);
+    user.setPasswordHash(key.verifier());
+    return key;
+}
+
 bool UserManager::userExists(const QString& username) const {
     for (const User& user : m_users) {
         if (user.getUsername() == username) {
@@ -39,6 +39,8 @@ private:
     UserManager& operator=(const UserManager&) = delete;
 
     QString getUsersFilePath() const;
+    // Gives the account a fresh salt and verifier; returns the derived key
+    static SessionKey assignNewKey(User& user, const QString& password);
 
     QList<User> m_users;
     User* m_currentUser;